@@ -0,0 +1,239 @@
+#===============================================================================
+# Prints the footprint of each module in the LidarParser library and checks the
+# parser core against the configured budgets.
+#
+# Inputs (passed with -D):
+#   SIZE_TOOL     - binutils `size` program for the target
+#   NM_TOOL       - binutils `nm` program for the target
+#   LIBRARY       - path to the LidarParser static library
+#   OBJECT_DIR    - directory holding the object, .su and .ci files of the library
+#   CORE_MODULES  - '|' separated source names that make up the parser core
+#   FLASH_BUDGET  - maximum code size of the core in bytes, 0 to skip the check
+#   RAM_BUDGET    - maximum static RAM of the core in bytes, 0 to skip the check
+#   STACK_BUDGET  - maximum stack depth of the core in bytes, 0 to skip the check
+#===============================================================================
+
+cmake_policy(SET CMP0057 NEW) # if(IN_LIST)
+
+if(NOT SIZE_TOOL)
+	message(FATAL_ERROR "No `size` tool was found for this toolchain")
+endif()
+
+string(REPLACE "|" ";" CORE_MODULES "${CORE_MODULES}")
+
+execute_process(
+	COMMAND ${SIZE_TOOL} ${LIBRARY}
+	OUTPUT_VARIABLE size_output
+	RESULT_VARIABLE result
+)
+if(result)
+	message(FATAL_ERROR "${SIZE_TOOL} failed: ${result}")
+endif()
+
+#-------------------------------------------------------------------------------
+# stack depth per module
+#
+# With GCC the .ci files written by -fcallgraph-info=su hold every function's
+# frame and its calls, so the depth of a function is its frame plus the
+# deepest of its callees. Indirect calls are the stream and measurement
+# buffer callbacks, whose stack belongs to the application and is not
+# counted. Other compilers only give the .su files of -fstack-usage, in which
+# case the largest single frame is reported as a lower bound.
+#-------------------------------------------------------------------------------
+
+file(GLOB_RECURSE graph_files "${OBJECT_DIR}/*.ci")
+set(functions "")
+set(stack_is_call_graph FALSE)
+set(stack_is_bounded TRUE)
+
+if(graph_files)
+	set(stack_is_call_graph TRUE)
+	foreach(graph_file ${graph_files})
+		get_filename_component(module ${graph_file} NAME)
+		string(REGEX REPLACE "\\.ci$" "" module ${module})
+		file(STRINGS ${graph_file} lines)
+		foreach(line ${lines})
+			if(line MATCHES "^node: { title: \"([^\"]+)\" label: \"[^\"]*\\\\n([0-9]+) bytes \\(([a-z,]+)\\)")
+				string(MAKE_C_IDENTIFIER "${CMAKE_MATCH_1}" id)
+				list(APPEND functions ${id})
+				set(frame_${id} ${CMAKE_MATCH_2})
+				set(module_${id} ${module})
+				if(NOT CMAKE_MATCH_3 STREQUAL "static")
+					set(stack_is_bounded FALSE)
+				endif()
+			elseif(line MATCHES "^edge: { sourcename: \"([^\"]+)\" targetname: \"([^\"]+)\"")
+				string(MAKE_C_IDENTIFIER "${CMAKE_MATCH_1}" caller)
+				string(MAKE_C_IDENTIFIER "${CMAKE_MATCH_2}" callee)
+				list(APPEND callees_${caller} ${callee})
+			endif()
+		endforeach()
+	endforeach()
+
+	# relax depth = frame + deepest callee until nothing changes; the graph of
+	# a non-recursive library settles within one pass per function
+	foreach(id ${functions})
+		set(depth_${id} ${frame_${id}})
+	endforeach()
+	list(LENGTH functions passes_left)
+	set(changed TRUE)
+	while(changed)
+		if(passes_left LESS 0)
+			message(FATAL_ERROR "The call graph is recursive, so its stack depth is unbounded")
+		endif()
+		math(EXPR passes_left "${passes_left} - 1")
+		set(changed FALSE)
+		foreach(id ${functions})
+			set(deepest 0)
+			foreach(callee ${callees_${id}})
+				if(DEFINED depth_${callee} AND depth_${callee} GREATER deepest)
+					set(deepest ${depth_${callee}})
+				endif()
+			endforeach()
+			math(EXPR depth "${frame_${id}} + ${deepest}")
+			if(NOT depth EQUAL depth_${id})
+				set(depth_${id} ${depth})
+				set(changed TRUE)
+			endif()
+		endforeach()
+	endwhile()
+
+	foreach(id ${functions})
+		set(module ${module_${id}})
+		if(NOT DEFINED stack_${module} OR depth_${id} GREATER stack_${module})
+			set(stack_${module} ${depth_${id}})
+		endif()
+	endforeach()
+else()
+	file(GLOB_RECURSE stack_files "${OBJECT_DIR}/*.su")
+	foreach(stack_file ${stack_files})
+		get_filename_component(module ${stack_file} NAME)
+		string(REGEX REPLACE "\\.su$" "" module ${module})
+		file(STRINGS ${stack_file} frames)
+		set(largest 0)
+		foreach(frame ${frames})
+			if(frame MATCHES "\t([0-9]+)\t([a-z,]+)")
+				if(CMAKE_MATCH_1 GREATER largest)
+					set(largest ${CMAKE_MATCH_1})
+				endif()
+				if(NOT CMAKE_MATCH_2 STREQUAL "static")
+					set(stack_is_bounded FALSE)
+				endif()
+			endif()
+		endforeach()
+		set(stack_${module} ${largest})
+	endforeach()
+endif()
+
+#-------------------------------------------------------------------------------
+# report
+#-------------------------------------------------------------------------------
+
+if(stack_is_call_graph)
+	set(stack_column "stack depth")
+else()
+	set(stack_column "largest stack frame")
+endif()
+
+set(core_flash 0)
+set(core_ram 0)
+set(core_stack 0)
+message("module                 code\tstatic RAM\t${stack_column}")
+string(REPLACE "\n" ";" lines "${size_output}")
+foreach(line ${lines})
+	# Berkeley format: text data bss dec hex filename
+	if(NOT line MATCHES "^ *([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+([^ \t]+)")
+		continue()
+	endif()
+	set(text ${CMAKE_MATCH_1})
+	math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+	math(EXPR flash "${text} + ${CMAKE_MATCH_2}")
+	get_filename_component(object ${CMAKE_MATCH_4} NAME)
+	string(REGEX REPLACE "\\.(o|obj)$" "" module ${object})
+
+	set(stack "?")
+	if(DEFINED stack_${module})
+		set(stack ${stack_${module}})
+	endif()
+
+	set(name ${module})
+	string(APPEND module "                         ")
+	string(SUBSTRING "${module}" 0 22 module_column)
+	message("${module_column} ${flash}\t${ram}\t\t${stack}")
+
+	if(name IN_LIST CORE_MODULES)
+		math(EXPR core_flash "${core_flash} + ${flash}")
+		math(EXPR core_ram "${core_ram} + ${ram}")
+		if(DEFINED stack_${name} AND stack_${name} GREATER core_stack)
+			set(core_stack ${stack_${name}})
+		endif()
+	endif()
+endforeach()
+
+message("parser core: ${core_flash} bytes code, ${core_ram} bytes static RAM, ${core_stack} bytes stack (${stack_column}, excluding callbacks)")
+if(NOT stack_is_bounded)
+	message(WARNING "Some functions have dynamically sized frames, so the stack figures are not an upper bound")
+endif()
+
+if(FLASH_BUDGET GREATER 0 AND core_flash GREATER FLASH_BUDGET)
+	message(FATAL_ERROR "Parser core code size ${core_flash} exceeds budget of ${FLASH_BUDGET} bytes")
+endif()
+if(RAM_BUDGET GREATER 0 AND core_ram GREATER RAM_BUDGET)
+	message(FATAL_ERROR "Parser core static RAM ${core_ram} exceeds budget of ${RAM_BUDGET} bytes")
+endif()
+if(STACK_BUDGET GREATER 0 AND core_stack GREATER STACK_BUDGET)
+	message(FATAL_ERROR "Parser core stack depth ${core_stack} exceeds budget of ${STACK_BUDGET} bytes")
+endif()
+
+#-------------------------------------------------------------------------------
+# external dependencies
+#
+# The core must link on a bare-metal target without libc or libm, so every
+# symbol it uses has to be defined within the library itself.
+#-------------------------------------------------------------------------------
+
+if(NOT NM_TOOL)
+	message(FATAL_ERROR "No `nm` tool was found for this toolchain")
+endif()
+
+execute_process(
+	COMMAND ${NM_TOOL} -g ${LIBRARY}
+	OUTPUT_VARIABLE nm_output
+	RESULT_VARIABLE result
+)
+if(result)
+	message(FATAL_ERROR "${NM_TOOL} failed: ${result}")
+endif()
+
+set(defined "")
+set(core_undefined "")
+set(in_core FALSE)
+string(REPLACE "\n" ";" lines "${nm_output}")
+foreach(line ${lines})
+	if(line MATCHES "^(.+)\\.(o|obj):$")
+		get_filename_component(module ${CMAKE_MATCH_1} NAME)
+		if(module IN_LIST CORE_MODULES)
+			set(in_core TRUE)
+		else()
+			set(in_core FALSE)
+		endif()
+	elseif(line MATCHES "^ +U ([^ ]+)$")
+		if(in_core)
+			list(APPEND core_undefined ${CMAKE_MATCH_1})
+		endif()
+	elseif(line MATCHES "^[0-9a-fA-F]+ [A-TV-Z] ([^ ]+)$")
+		list(APPEND defined ${CMAKE_MATCH_1})
+	endif()
+endforeach()
+
+set(external "")
+foreach(symbol ${core_undefined})
+	if(NOT symbol IN_LIST defined)
+		list(APPEND external ${symbol})
+	endif()
+endforeach()
+if(external)
+	list(REMOVE_DUPLICATES external)
+	string(REPLACE ";" ", " external "${external}")
+	message(FATAL_ERROR "Parser core needs symbols from outside the library: ${external}")
+endif()
+message("parser core needs no libc or libm symbols")
@@ -1,6 +1,8 @@
 #ifndef LIDAR_MEASUREMENT_BUFFER_H
 #define LIDAR_MEASUREMENT_BUFFER_H
 
+/// The scan processing modules provide AddMeasurement and GetSize functions
+/// with these signatures, so any of them can be handed to LidarParser_Init.
 typedef struct {
 
 	/// Method to construct a measurement and add it to the buffer.
@@ -4,6 +4,8 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include "LidarInputStream.h"
 #include "LidarMeasurementBuffer.h"
 
@@ -21,6 +23,49 @@ void LidarParser_Init (LidarInputStream_i *, LidarMeasurementBuffer_i *);
 ///=============================================================================
 void LidarParser_Parse ();
 
+///=============================================================================
+/// Masks the angles first_angle..last_angle (inclusive, in degrees) so that
+/// measurements at those angles are not added to the measurement buffer. The
+/// range wraps around when first_angle > last_angle. Packets are still
+/// validated; packets whose four angles are all masked are dropped without
+/// touching the measurement buffer.
+///
+/// Returns false, leaving the mask unchanged, unless
+/// 0 <= first_angle, last_angle < 360.
+///
+/// Preconditions:
+///  - Module has been initialized (initialization clears the mask).
+///=============================================================================
+bool LidarParser_MaskAngles (int first_angle, int last_angle);
+
+///=============================================================================
+/// Removes all masked angles.
+///=============================================================================
+void LidarParser_ClearMask ();
+
+///=============================================================================
+/// Returns the number of bytes needed to hold a saved parser state.
+///=============================================================================
+size_t LidarParser_GetStateSize ();
+
+///=============================================================================
+/// Copies the complete parser state (interfaces, partially received bytes,
+/// mask) into the given storage. Together with LidarParser_RestoreState this
+/// allows one parser to be shared between several lidars, by restoring each
+/// lidar's state before calling LidarParser_Parse and saving it afterwards.
+///
+/// Preconditions:
+///  - state points to LidarParser_GetStateSize() bytes, suitably aligned for
+///    any object type.
+///=============================================================================
+void LidarParser_SaveState (void * state);
+
+///=============================================================================
+/// Replaces the parser state with one previously saved by
+/// LidarParser_SaveState.
+///=============================================================================
+void LidarParser_RestoreState (const void * state);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,43 @@
+#ifndef LIDAR_SCAN_H
+#define LIDAR_SCAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Number of angle slots in one revolution (one per degree). Slot i holds the
+/// measurement whose normalized index is i.
+#define LidarScan_NUM_ANGLES 360
+
+typedef struct {
+
+	/// Distance per angle slot; 0 indicates that no return was measured.
+	uint16_t distance[LidarScan_NUM_ANGLES];
+
+} LidarScan_t;
+
+/// Finds revolution boundaries in a stream of measurements. The lidar sweeps
+/// the indices in increasing order, so an index that does not increase over
+/// the previous one starts a new revolution.
+typedef struct {
+
+	/// Index of the previous measurement, or -1 if there was none.
+	int last_index;
+
+} LidarRevolution_t;
+
+/// Forgets the previous measurement.
+static inline void LidarRevolution_Reset (LidarRevolution_t * revolution)
+{
+	revolution->last_index = -1;
+}
+
+/// Records the index of a measurement and returns whether it starts a new
+/// revolution.
+static inline bool LidarRevolution_Next (LidarRevolution_t * revolution, int index)
+{
+	bool is_new = revolution->last_index >= 0 && index <= revolution->last_index;
+	revolution->last_index = index;
+	return is_new;
+}
+
+#endif // LIDAR_SCAN_H
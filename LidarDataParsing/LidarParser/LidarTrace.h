@@ -0,0 +1,84 @@
+#ifndef LIDAR_TRACE_H
+#define LIDAR_TRACE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///=============================================================================
+/// Optional tracing of the parser's hot path.
+///
+/// When the library is built with LIDAR_PARSER_TRACE, the parser records the
+/// start and end of each state machine stage and of each measurement buffer
+/// call into a ring of the calling thread. The rings can be written out in
+/// Chrome trace JSON format and opened in chrome://tracing or Perfetto.
+/// Without LIDAR_PARSER_TRACE the trace points compile to nothing.
+///
+/// The rings are static: LidarTrace_MAX_THREADS rings of LidarTrace_RING_SIZE
+/// events take about 786 KB of RAM on a 64-bit target. A thread claims a ring
+/// for good the first time it records an event, and rings are not given back
+/// when the thread exits or the trace is cleared, so once
+/// LidarTrace_MAX_THREADS threads have recorded events, every later thread is
+/// not traced (see LidarTrace_GetDroppedThreadCount).
+///=============================================================================
+
+#ifdef LIDAR_PARSER_TRACE
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// Number of events each thread's ring holds before overwriting the oldest.
+#define LidarTrace_RING_SIZE 4096
+
+/// Maximum number of threads that can record events over the whole run.
+#define LidarTrace_MAX_THREADS 8
+
+///=============================================================================
+/// Records the beginning/end of a named span on the calling thread. The name
+/// must outlive the trace (normally a string literal).
+///=============================================================================
+void LidarTrace_Begin (const char * name);
+void LidarTrace_End (const char * name);
+
+///=============================================================================
+/// Replaces the clock used for timestamps (nanoseconds, monotonic). By default
+/// CLOCK_MONOTONIC is used where available.
+///=============================================================================
+void LidarTrace_SetClock (uint64_t (*now_ns) (void));
+
+///=============================================================================
+/// Writes the recorded events of all threads as Chrome trace JSON. The ends of
+/// spans whose beginnings have been overwritten are left out.
+///
+/// Preconditions:
+///  - No thread is recording events.
+///=============================================================================
+void LidarTrace_Dump (FILE * file);
+
+///=============================================================================
+/// Discards all recorded events.
+///
+/// Preconditions:
+///  - No thread is recording events.
+///=============================================================================
+void LidarTrace_Clear ();
+
+///=============================================================================
+/// Returns the number of threads whose events were not recorded because all
+/// rings had already been claimed.
+///=============================================================================
+int LidarTrace_GetDroppedThreadCount ();
+
+#define LIDAR_TRACE_BEGIN(name) LidarTrace_Begin(name)
+#define LIDAR_TRACE_END(name)   LidarTrace_End(name)
+
+#else
+
+#define LIDAR_TRACE_BEGIN(name) ((void)0)
+#define LIDAR_TRACE_END(name)   ((void)0)
+
+#endif // LIDAR_PARSER_TRACE
+
+#ifdef __cplusplus
+}
+#endif
+#endif // LIDAR_TRACE_H
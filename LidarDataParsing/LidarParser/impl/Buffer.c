@@ -1,4 +1,4 @@
-#include "buffer.h"
+#include "Buffer.h"
 
 void Buffer_init(Buffer_t * buffer)
 {
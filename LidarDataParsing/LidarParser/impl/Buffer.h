@@ -8,13 +8,22 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 
+#ifndef MAX_BUFFER_SIZE
 #define MAX_BUFFER_SIZE 200
+#endif
+
+// use the narrowest type that can index the buffer to keep the state compact
+#if MAX_BUFFER_SIZE <= UINT8_MAX
+typedef uint8_t BufferIndex_t;
+#else
+typedef size_t BufferIndex_t;
+#endif
 
 typedef struct {
 	uint8_t data[MAX_BUFFER_SIZE];
-	size_t size;
-	size_t head;
-	size_t tail;
+	BufferIndex_t size;
+	BufferIndex_t head;
+	BufferIndex_t tail;
 } Buffer_t;
 
 void Buffer_init(Buffer_t *);
@@ -11,10 +11,34 @@
 
 //==============================================================================
 // packet state
+//
+// Rather than keeping a copy of all 22 bytes, the packet retains only the
+// fields that are read back later and accumulates the checksum as the bytes
+// arrive. The packet is processed as 11 little-endian 16-bit words:
+//   word 0:        start byte, index byte
+//   word 1:        speed
+//   words 2..9:    data 0..3 (distance word, signal strength word)
+//   word 10:       checksum
 //==============================================================================
 
-static uint8_t packet_bytes[LidarPacket_NUM_BYTES_PER_PACKET];
-static int index;
+#define LidarPacket_NUM_CHECKSUM_WORDS 10
+
+static struct
+{
+	// number of bytes added since the last reset
+	uint8_t num_bytes;
+
+	// least significant byte of the word currently being received
+	uint8_t lsb;
+
+	uint8_t index_byte;
+	uint16_t distance_words[4];
+	uint16_t received_checksum;
+
+	// checksum accumulated over the first 10 words
+	uint32_t checksum;
+}
+packet;
 
 //==============================================================================
 // helper methods
@@ -27,42 +51,62 @@ bool isValidIndex(uint8_t byte)
 
 uint8_t getIndexByte()
 {
-	return packet_bytes[1];
+	return packet.index_byte;
 }
 
-
 //==============================================================================
-// Calculates checksum based on first 20 bytes (including start byte).
+// Folds the checksum accumulated over the first 20 bytes (including start
+// byte) into its final form.
 //==============================================================================
 uint16_t calculateChecksum()
 {
-	// combine the bytes into 16 bit values
-	uint16_t combined[10];
-	for (int i = 0; i < 10; ++i)
-		combined[i] = packet_bytes[2 * i] + ((uint16_t)packet_bytes[2 * i + 1] << 8);
-
-	// compute the checksum
-	uint32_t checksum = 0;
-	for (int i = 0; i < 10; ++i)
-		checksum = (checksum << 1) + combined[i];
+	uint32_t checksum = packet.checksum;
 	checksum = (checksum & 0x7FFF) + (checksum >> 15);
 
 	// truncate the result to 15 bits
 	return checksum & 0x7FFFF;
 }
 
+//==============================================================================
+// Stores a complete word in the field it belongs to, and accumulates it into
+// the checksum.
+//==============================================================================
+void addWord(int word_index, uint16_t word)
+{
+	if (word_index < LidarPacket_NUM_CHECKSUM_WORDS)
+		packet.checksum = (packet.checksum << 1) + word;
+	else
+		packet.received_checksum = word;
+
+	// data words 2, 4, 6 and 8 hold the distances
+	if (word_index >= 2 && word_index <= 8 && (word_index & 1) == 0)
+		packet.distance_words[(word_index >> 1) - 1] = word;
+}
+
 //==============================================================================
 // public methods
 //==============================================================================
 
 void Packet_reset()
 {
-	index = 0;
+	packet.num_bytes = 0;
+	packet.checksum = 0;
 }
 
 void Packet_add(uint8_t byte)
 {
-	packet_bytes[index++] = byte;
+	int i = packet.num_bytes;
+	if (i >= LidarPacket_NUM_BYTES_PER_PACKET)
+		return;
+	++packet.num_bytes;
+
+	if (i == 1)
+		packet.index_byte = byte;
+
+	if ((i & 1) == 0)
+		packet.lsb = byte;
+	else
+		addWord(i >> 1, packet.lsb + ((uint16_t)byte << 8));
 }
 
 bool Packet_isValid()
@@ -72,7 +116,7 @@ bool Packet_isValid()
 		return false;
 
 	// validate the checksum
-	uint16_t packet_checksum = packet_bytes[20] + ((uint16_t)packet_bytes[21] << 8);
+	uint16_t packet_checksum = packet.received_checksum;
 	uint16_t calculated_checksum = calculateChecksum();
 	if (packet_checksum != calculated_checksum)
 		return false;
@@ -112,34 +156,34 @@ int Packet_getIndex4()
 
 #define DISTANCE_MASK ~(1 << 14 | 1 << 15)
 
-int Packet_getDistance1()
+// set when the lidar could not measure the distance; the low bits then hold an
+// error code rather than a distance
+#define INVALID_DATA_FLAG (1 << 15)
+
+static int getDistance(int n)
 {
-	uint16_t lsb = packet_bytes[4];
-	uint16_t msb = packet_bytes[5];
-	uint16_t distance = (lsb + (msb << 8)) & DISTANCE_MASK;
+	if (packet.distance_words[n] & INVALID_DATA_FLAG)
+		return 0;
+	uint16_t distance = packet.distance_words[n] & DISTANCE_MASK;
 	return distance;
 }
 
+int Packet_getDistance1()
+{
+	return getDistance(0);
+}
+
 int Packet_getDistance2()
 {
-	uint16_t lsb = packet_bytes[8];
-	uint16_t msb = packet_bytes[9];
-	uint16_t distance = (lsb + (msb << 8)) & DISTANCE_MASK;
-	return distance;
+	return getDistance(1);
 }
 
 int Packet_getDistance3()
 {
-	uint16_t lsb = packet_bytes[12];
-	uint16_t msb = packet_bytes[13];
-	uint16_t distance = (lsb + (msb << 8)) & DISTANCE_MASK;
-	return distance;
+	return getDistance(2);
 }
 
 int Packet_getDistance4()
 {
-	uint16_t lsb = packet_bytes[16];
-	uint16_t msb = packet_bytes[17];
-	uint16_t distance = (lsb + (msb << 8)) & DISTANCE_MASK;
-	return distance;
+	return getDistance(3);
 }
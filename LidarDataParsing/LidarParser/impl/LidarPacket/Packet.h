@@ -2,6 +2,7 @@
 #define PACKET_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define LidarPacket_START_BYTE 0xFA
 #define LidarPacket_NUM_BYTES_PER_PACKET 22
@@ -1,9 +1,16 @@
 #include "LidarParser.h"
 #include "LidarInputStream.h"
 #include "LidarMeasurementBuffer.h"
+#include "LidarScan.h"
+#include "LidarTrace.h"
 #include "LidarPacket/Packet.h"
 #include "Buffer.h"
 
+// the parsing buffer must be able to hold at least one complete packet
+#if MAX_BUFFER_SIZE < LidarPacket_NUM_BYTES_PER_PACKET
+#error "MAX_BUFFER_SIZE is too small to hold a lidar packet"
+#endif
+
 // interfaces
 static LidarInputStream_i * s_stream;
 static LidarMeasurementBuffer_i * s_buffer;
@@ -20,7 +27,20 @@ typedef enum
 }
 ParsingStage_t;
 
-static struct
+#ifdef LIDAR_PARSER_TRACE
+// trace span names, indexed by parsing stage
+static const char * const stage_trace_names[] =
+{
+	"Handler_ResettingParser",
+	"Handler_GettingStartByte",
+	"Handler_GetPayloadBytes",
+	"Handler_ValidatingPacket",
+	"Handler_AddingMeasurementToBuffer",
+	"Handler_StopParsing"
+};
+#endif
+
+typedef struct
 {
 	// finite state of parsing system
 	ParsingStage_t stage;
@@ -30,9 +50,23 @@ static struct
 
 	// buffer containing raw bytes to be parsed
 	Buffer_t buffer;
-	size_t index;
+	BufferIndex_t index;
+
+	// one bit per angle; set bits are not added to the measurement buffer
+	uint8_t mask[LidarScan_NUM_ANGLES / 8];
 }
-parser;
+Parser_t;
+
+static Parser_t parser;
+
+// everything that LidarParser_SaveState/LidarParser_RestoreState carry over
+typedef struct
+{
+	LidarInputStream_i * stream;
+	LidarMeasurementBuffer_i * buffer;
+	Parser_t parser;
+}
+SavedState_t;
 
 void LidarParser_Init (LidarInputStream_i * stream, LidarMeasurementBuffer_i * buffer)
 {
@@ -49,6 +83,54 @@ void LidarParser_Init (LidarInputStream_i * stream, LidarMeasurementBuffer_i * b
 
 	// reset the packet
 	Packet_reset();
+
+	LidarParser_ClearMask();
+}
+
+static bool isValidAngle(int angle)
+{
+	return angle >= 0 && angle < LidarScan_NUM_ANGLES;
+}
+
+bool LidarParser_MaskAngles (int first_angle, int last_angle)
+{
+	if (!isValidAngle(first_angle) || !isValidAngle(last_angle))
+		return false;
+
+	for (int angle = first_angle; ; angle = (angle + 1) % LidarScan_NUM_ANGLES)
+	{
+		parser.mask[angle >> 3] |= (uint8_t)(1 << (angle & 7));
+		if (angle == last_angle)
+			break;
+	}
+	return true;
+}
+
+void LidarParser_ClearMask ()
+{
+	for (int i = 0; i < LidarScan_NUM_ANGLES / 8; ++i)
+		parser.mask[i] = 0;
+}
+
+size_t LidarParser_GetStateSize ()
+{
+	return sizeof(SavedState_t);
+}
+
+void LidarParser_SaveState (void * state)
+{
+	SavedState_t * saved = (SavedState_t *)state;
+	saved->stream = s_stream;
+	saved->buffer = s_buffer;
+	saved->parser = parser;
+}
+
+void LidarParser_RestoreState (const void * state)
+{
+	const SavedState_t * saved = (const SavedState_t *)state;
+	s_stream = saved->stream;
+	s_buffer = saved->buffer;
+	parser = saved->parser;
 }
 
 //==============================================================================
@@ -70,6 +152,37 @@ bool isValidStartByte(uint8_t byte)
 	return byte == LidarPacket_START_BYTE;
 }
 
+bool isMasked(int angle)
+{
+	return (parser.mask[angle >> 3] >> (angle & 7)) & 1;
+}
+
+//==============================================================================
+// A packet covers four consecutive angles starting at a multiple of 4, which
+// is one nibble of the mask.
+//==============================================================================
+bool isPacketMasked()
+{
+	int angle = Packet_getIndex1();
+	return ((parser.mask[angle >> 3] >> (angle & 7)) & 0xF) == 0xF;
+}
+
+void addMeasurementIfNotMasked(int index, int distance)
+{
+	if (isMasked(index))
+		return;
+
+	LIDAR_TRACE_BEGIN("AddMeasurement");
+	s_buffer->AddMeasurement(index, distance);
+	LIDAR_TRACE_END("AddMeasurement");
+}
+
+void removePacketFromBuffer()
+{
+	for (int i = 0; i < LidarPacket_NUM_BYTES_PER_PACKET; ++i)
+		Buffer_pop(&parser.buffer);
+}
+
 //==============================================================================
 // State Machine Handlers
 //==============================================================================
@@ -144,20 +257,27 @@ void Handler_ValidatingPacket()
 		return;
 	}
 
+	// for valid packets that lie entirely in the masked sector, drop them
+	if (isPacketMasked())
+	{
+		removePacketFromBuffer();
+		parser.stage = ResettingParser;
+		return;
+	}
+
 	// for valid packets, add their payload to the measurement buffer
 	parser.stage = AddingMeasurementToBuffer;
 }
 
 void Handler_AddingMeasurementToBuffer()
 {
-	s_buffer->AddMeasurement(Packet_getIndex1(), Packet_getDistance1());
-	s_buffer->AddMeasurement(Packet_getIndex2(), Packet_getDistance2());
-	s_buffer->AddMeasurement(Packet_getIndex3(), Packet_getDistance3());
-	s_buffer->AddMeasurement(Packet_getIndex4(), Packet_getDistance4());
+	addMeasurementIfNotMasked(Packet_getIndex1(), Packet_getDistance1());
+	addMeasurementIfNotMasked(Packet_getIndex2(), Packet_getDistance2());
+	addMeasurementIfNotMasked(Packet_getIndex3(), Packet_getDistance3());
+	addMeasurementIfNotMasked(Packet_getIndex4(), Packet_getDistance4());
 
 	// remove bytes from buffer
-	for (int i = 0; i < LidarPacket_NUM_BYTES_PER_PACKET; ++i)
-		Buffer_pop(&parser.buffer);
+	removePacketFromBuffer();
 
 	// start over
 	parser.stage = ResettingParser;
@@ -174,24 +294,37 @@ void Handler_StopParsing()
 
 void LidarParser_Parse()
 {
-	// transfer as many bytes as possible from stream to parsing buffer
-	while (!Buffer_full(&parser.buffer) && !s_stream->IsEmpty())
+	do
 	{
-		uint8_t byte = s_stream->GetByte();
-		Buffer_push(&parser.buffer, byte);
-	}
+		// transfer as many bytes as possible from stream to parsing buffer
+		while (!Buffer_full(&parser.buffer) && !s_stream->IsEmpty())
+		{
+			uint8_t byte = s_stream->GetByte();
+			Buffer_push(&parser.buffer, byte);
+		}
 
-	while (parser.continue_parsing)
-	{
-		switch (parser.stage)
+		// rescan the buffer from the start of any partially received packet
+		parser.stage = ResettingParser;
+		parser.continue_parsing = true;
+
+		while (parser.continue_parsing)
 		{
-		case ResettingParser:           Handler_ResettingParser(); break;
-		case GettingStartByte:          Handler_GettingStartByte(); break;
-		case GettingPayloadBytes:       Handler_GetPayloadBytes(); break;
-		case ValidatingPacket:          Handler_ValidatingPacket(); break;
-		case AddingMeasurementToBuffer: Handler_AddingMeasurementToBuffer(); break;
-		case StopParsing:               Handler_StopParsing(); break;
+			ParsingStage_t stage = parser.stage;
+			LIDAR_TRACE_BEGIN(stage_trace_names[stage]);
+
+			switch (stage)
+			{
+			case ResettingParser:           Handler_ResettingParser(); break;
+			case GettingStartByte:          Handler_GettingStartByte(); break;
+			case GettingPayloadBytes:       Handler_GetPayloadBytes(); break;
+			case ValidatingPacket:          Handler_ValidatingPacket(); break;
+			case AddingMeasurementToBuffer: Handler_AddingMeasurementToBuffer(); break;
+			case StopParsing:               Handler_StopParsing(); break;
+			}
+
+			LIDAR_TRACE_END(stage_trace_names[stage]);
 		}
 	}
-}
-
+	// the parsing buffer has room again, so keep going until the stream is drained
+	while (!s_stream->IsEmpty());
+}
\ No newline at end of file
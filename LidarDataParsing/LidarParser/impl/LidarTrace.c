@@ -0,0 +1,161 @@
+#include "LidarTrace.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define HAVE_CLOCK_MONOTONIC
+#endif
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+//==============================================================================
+// trace state
+//
+// Each thread claims a ring the first time it records an event, and is the
+// only writer of that ring, so recording needs no locks. The event count is
+// published with release semantics after the event is written. num_rings
+// counts the claims, including those of threads that found every ring taken.
+//==============================================================================
+
+typedef struct
+{
+	const char * name;
+	uint64_t timestamp_ns;
+	char phase;
+}
+Event_t;
+
+typedef struct
+{
+	Event_t events[LidarTrace_RING_SIZE];
+	atomic_uint_fast32_t count;
+}
+Ring_t;
+
+static Ring_t rings[LidarTrace_MAX_THREADS];
+static atomic_int num_rings;
+
+static THREAD_LOCAL Ring_t * thread_ring;
+static THREAD_LOCAL bool thread_has_no_ring;
+
+//==============================================================================
+// helper methods
+//==============================================================================
+
+static uint64_t defaultClock(void)
+{
+#ifdef HAVE_CLOCK_MONOTONIC
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+static uint64_t (*s_now_ns) (void) = defaultClock;
+
+static Ring_t * getThreadRing()
+{
+	if (thread_ring || thread_has_no_ring)
+		return thread_ring;
+
+	int number = atomic_fetch_add(&num_rings, 1);
+	if (number < LidarTrace_MAX_THREADS)
+		thread_ring = &rings[number];
+	else
+		thread_has_no_ring = true;
+	return thread_ring;
+}
+
+static void record(const char * name, char phase)
+{
+	Ring_t * ring = getThreadRing();
+	if (!ring)
+		return;
+
+	uint_fast32_t count = atomic_load_explicit(&ring->count, memory_order_relaxed);
+	Event_t * event = &ring->events[count % LidarTrace_RING_SIZE];
+	event->name = name;
+	event->timestamp_ns = s_now_ns();
+	event->phase = phase;
+	atomic_store_explicit(&ring->count, count + 1, memory_order_release);
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void LidarTrace_Begin(const char * name)
+{
+	record(name, 'B');
+}
+
+void LidarTrace_End(const char * name)
+{
+	record(name, 'E');
+}
+
+void LidarTrace_SetClock(uint64_t (*now_ns) (void))
+{
+	s_now_ns = now_ns;
+}
+
+void LidarTrace_Dump(FILE * file)
+{
+	int used_rings = atomic_load(&num_rings);
+	if (used_rings > LidarTrace_MAX_THREADS)
+		used_rings = LidarTrace_MAX_THREADS;
+
+	bool first = true;
+	fprintf(file, "{\"traceEvents\":[");
+	for (int thread = 0; thread < used_rings; ++thread)
+	{
+		Ring_t * ring = &rings[thread];
+		uint_fast32_t count = atomic_load_explicit(&ring->count, memory_order_acquire);
+		uint_fast32_t oldest = (count > LidarTrace_RING_SIZE) ? count - LidarTrace_RING_SIZE : 0;
+
+		// spans open at this point of the ring; once it has wrapped, the ends
+		// of spans whose beginnings were overwritten have nothing to close
+		uint_fast32_t open_spans = 0;
+		for (uint_fast32_t i = oldest; i < count; ++i)
+		{
+			const Event_t * event = &ring->events[i % LidarTrace_RING_SIZE];
+			if (event->phase == 'B')
+				++open_spans;
+			else if (open_spans == 0)
+				continue;
+			else
+				--open_spans;
+
+			fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%d}",
+				first ? "" : ",",
+				event->name,
+				event->phase,
+				(unsigned long long)(event->timestamp_ns / 1000),
+				(unsigned)(event->timestamp_ns % 1000),
+				thread);
+			first = false;
+		}
+	}
+	fprintf(file, "\n]}\n");
+}
+
+void LidarTrace_Clear()
+{
+	for (int thread = 0; thread < LidarTrace_MAX_THREADS; ++thread)
+		atomic_store(&rings[thread].count, 0);
+}
+
+int LidarTrace_GetDroppedThreadCount()
+{
+	int claims = atomic_load(&num_rings);
+	return (claims > LidarTrace_MAX_THREADS) ? claims - LidarTrace_MAX_THREADS : 0;
+}
@@ -0,0 +1,257 @@
+#ifndef LIDAR_PARSER_ASYNC_H
+#define LIDAR_PARSER_ASYNC_H
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include <poll.h>
+
+#include "LidarScan.h"
+
+///=============================================================================
+/// C++20 coroutine interface to the lidar parser.
+///
+/// A LidarSensor wraps one lidar: it owns a saved parser state, and parses the
+/// bytes it is fed (either directly with Feed, or read from its file
+/// descriptor by a LidarEventLoop). Coroutines wait for the sensor's output
+/// with
+///
+///     co_await sensor.NextPacket();
+///     co_await sensor.NextSector(first_angle, last_angle);
+///     co_await sensor.NextScan();
+///
+/// Waiting coroutines are resumed on the thread that feeds the sensor, from
+/// inside LidarParser_Parse. While resumed they must not feed any sensor or
+/// call the LidarParser_* functions; awaiting again, masking angles and
+/// destroying tasks are fine. Sensors share the single parser module, so the
+/// C parser API must not be used directly while sensors exist.
+///=============================================================================
+
+struct LidarMeasurement
+{
+	uint16_t index;
+	uint16_t distance;
+};
+
+/// The measurements of one validated packet (fewer than 4 if masked).
+struct LidarPacketMeasurements
+{
+	LidarMeasurement measurements[4];
+	int size;
+};
+
+/// The most recent distances of a range of angles.
+struct LidarSector
+{
+	int first_angle;
+	int num_angles;
+	uint16_t distance[LidarScan_NUM_ANGLES];
+};
+
+///=============================================================================
+/// Coroutine return type for consumers of sensor output. The coroutine starts
+/// running immediately and is destroyed together with the task; a task that is
+/// destroyed while waiting stops waiting on its sensor.
+///=============================================================================
+class LidarTask
+{
+public:
+	struct promise_type
+	{
+		std::exception_ptr exception;
+
+		LidarTask get_return_object() { return LidarTask(Handle::from_promise(*this)); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { exception = std::current_exception(); }
+	};
+
+	LidarTask(LidarTask && other) noexcept : handle(other.handle) { other.handle = nullptr; }
+	LidarTask & operator=(LidarTask &&) = delete;
+	~LidarTask() { if (handle) handle.destroy(); }
+
+	/// Returns true once the coroutine has run to completion. Rethrows any
+	/// exception that escaped the coroutine.
+	bool Done() const
+	{
+		if (handle.promise().exception)
+			std::rethrow_exception(handle.promise().exception);
+		return handle.done();
+	}
+
+private:
+	using Handle = std::coroutine_handle<promise_type>;
+
+	explicit LidarTask(Handle handle) : handle(handle) {}
+
+	Handle handle;
+};
+
+class LidarSensor
+{
+public:
+	/// Creates a sensor that reads from the given non-blocking file descriptor
+	/// when added to a LidarEventLoop, or an in-memory sensor (fd = -1) that is
+	/// only fed through Feed.
+	explicit LidarSensor(int fd = -1);
+
+	LidarSensor(const LidarSensor &) = delete;
+	LidarSensor & operator=(const LidarSensor &) = delete;
+
+	int GetFd() const { return fd; }
+
+	/// Parses the given bytes, resuming any coroutines whose result becomes
+	/// available.
+	void Feed(const uint8_t * bytes, size_t count);
+
+	/// Reads whatever is available on the file descriptor and parses it.
+	/// Returns false once the descriptor reports end of file or an error.
+	bool ReadAvailable();
+
+	/// See LidarParser_MaskAngles. May be called from a resumed coroutine; when
+	/// called for the sensor being parsed, the mask applies from the next
+	/// measurement on, including the rest of the current packet.
+	bool MaskAngles(int first_angle, int last_angle);
+
+	//--------------------------------------------------------------------------
+	// awaitables
+	//
+	// An awaiter lives in the waiting coroutine's frame, so it remembers the
+	// coroutine until it is resumed and, if the frame is destroyed first,
+	// removes it from the sensor's waiters. The sensor must therefore outlive
+	// the tasks that wait on it.
+	//--------------------------------------------------------------------------
+
+	struct PacketAwaiter
+	{
+		LidarSensor & sensor;
+		std::coroutine_handle<> waiting = nullptr;
+
+		~PacketAwaiter() { if (waiting) sensor.StopWaiting(waiting); }
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) { waiting = handle; sensor.packet_waiters.push_back(handle); }
+		LidarPacketMeasurements await_resume() { waiting = nullptr; return sensor.packet; }
+	};
+
+	struct SectorAwaiter
+	{
+		LidarSensor & sensor;
+		int first_angle;
+		int last_angle;
+		std::coroutine_handle<> waiting = nullptr;
+
+		~SectorAwaiter() { if (waiting) sensor.StopWaiting(waiting); }
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle);
+		LidarSector await_resume();
+	};
+
+	struct ScanAwaiter
+	{
+		LidarSensor & sensor;
+		std::coroutine_handle<> waiting = nullptr;
+
+		~ScanAwaiter() { if (waiting) sensor.StopWaiting(waiting); }
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) { waiting = handle; sensor.scan_waiters.push_back(handle); }
+
+		/// The scan stays valid until the sensor completes its next revolution.
+		const LidarScan_t & await_resume() { waiting = nullptr; return sensor.scans[sensor.completed_scan]; }
+	};
+
+	/// Waits for the next validated packet.
+	PacketAwaiter NextPacket() { return PacketAwaiter{ *this }; }
+
+	/// Waits until the lidar sweeps past last_angle, then yields the most
+	/// recent distances from first_angle to last_angle (wrapping past 359).
+	SectorAwaiter NextSector(int first_angle, int last_angle) { return SectorAwaiter{ *this, first_angle, last_angle, nullptr }; }
+
+	/// Waits for the next complete revolution.
+	ScanAwaiter NextScan() { return ScanAwaiter{ *this }; }
+
+private:
+	struct SectorWaiter
+	{
+		std::coroutine_handle<> handle;
+		int last_angle;
+	};
+
+	static void AddMeasurement(uint16_t index, uint16_t distance);
+	static int GetSize();
+	static uint8_t GetByte();
+	static bool IsEmpty();
+
+	static void ResumeAll(std::vector<std::coroutine_handle<>> & waiters, std::vector<std::coroutine_handle<>> & scratch);
+
+	void StopWaiting(std::coroutine_handle<> handle);
+
+	void OnMeasurement(int index, int distance);
+	void FlushPacket();
+	void CompleteScan();
+	void ResumeSectors(int previous_index, int index, bool new_revolution);
+
+	int fd;
+
+	// saved LidarParser state, in units that guarantee its alignment
+	std::vector<std::max_align_t> parser_state;
+
+	// bytes currently being parsed
+	const uint8_t * input;
+	const uint8_t * input_end;
+
+	// output assembled from the measurements
+	LidarPacketMeasurements packet;
+	LidarRevolution_t revolution;
+	int num_measurements;
+	LidarScan_t latest;
+	LidarScan_t scans[2];
+	int completed_scan;
+
+	std::vector<std::coroutine_handle<>> packet_waiters;
+	std::vector<SectorWaiter> sector_waiters;
+	std::vector<std::coroutine_handle<>> scan_waiters;
+
+	// waiters being resumed
+	std::vector<std::coroutine_handle<>> resuming;
+	std::vector<SectorWaiter> resuming_sectors;
+};
+
+///=============================================================================
+/// Single-threaded executor that waits for any of its sensors' file
+/// descriptors to become readable and feeds the available bytes to the
+/// sensor. Sensors are removed once their descriptor reaches end of file.
+///=============================================================================
+class LidarEventLoop
+{
+public:
+	void Add(LidarSensor & sensor);
+	void Remove(LidarSensor & sensor);
+
+	/// Waits up to timeout_ms (-1 = indefinitely) for input and dispatches it.
+	/// Returns false if there are no sensors left to wait on.
+	bool RunOnce(int timeout_ms);
+
+	/// Dispatches input until Stop is called or no sensors are left.
+	void Run();
+
+	/// Makes Run return after the current dispatch; may be called from a
+	/// resumed coroutine.
+	void Stop() { stopped = true; }
+
+private:
+	std::vector<LidarSensor *> sensors;
+	bool stopped = false;
+
+	// poll state, reused between dispatches
+	std::vector<pollfd> fds;
+	std::vector<LidarSensor *> polled;
+};
+
+#endif // LIDAR_PARSER_ASYNC_H
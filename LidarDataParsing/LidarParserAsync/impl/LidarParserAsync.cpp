@@ -0,0 +1,286 @@
+#include "LidarParserAsync.h"
+
+#include "LidarParser.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <poll.h>
+#include <unistd.h>
+
+//==============================================================================
+// parser interfaces
+//
+// The parser's interfaces take no context argument, so they forward to the
+// sensor that is currently being fed.
+//==============================================================================
+
+static LidarSensor * s_current;
+
+static LidarInputStream_i s_stream;
+static LidarMeasurementBuffer_i s_buffer;
+
+uint8_t LidarSensor::GetByte()
+{
+	return *s_current->input++;
+}
+
+bool LidarSensor::IsEmpty()
+{
+	return s_current->input == s_current->input_end;
+}
+
+void LidarSensor::AddMeasurement(uint16_t index, uint16_t distance)
+{
+	s_current->OnMeasurement(index, distance);
+}
+
+int LidarSensor::GetSize()
+{
+	return s_current->num_measurements;
+}
+
+//==============================================================================
+// LidarSensor
+//==============================================================================
+
+LidarSensor::LidarSensor(int fd)
+	: fd(fd)
+	, parser_state((LidarParser_GetStateSize() + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t))
+	, input(nullptr)
+	, input_end(nullptr)
+	, packet{}
+	, revolution{ -1 }
+	, num_measurements(0)
+	, latest{}
+	, scans{}
+	, completed_scan(0)
+{
+	s_stream.GetByte = GetByte;
+	s_stream.IsEmpty = IsEmpty;
+	s_buffer.AddMeasurement = AddMeasurement;
+	s_buffer.GetSize = GetSize;
+
+	LidarParser_Init(&s_stream, &s_buffer);
+	LidarParser_SaveState(parser_state.data());
+}
+
+void LidarSensor::Feed(const uint8_t * bytes, size_t count)
+{
+	input = bytes;
+	input_end = bytes + count;
+
+	s_current = this;
+	LidarParser_RestoreState(parser_state.data());
+	LidarParser_Parse();
+	LidarParser_SaveState(parser_state.data());
+	s_current = nullptr;
+
+	// the parser only emits complete packets, so whatever is pending is done
+	FlushPacket();
+}
+
+bool LidarSensor::ReadAvailable()
+{
+	uint8_t bytes[256];
+	ssize_t count = read(fd, bytes, sizeof(bytes));
+	if (count > 0)
+	{
+		Feed(bytes, static_cast<size_t>(count));
+		return true;
+	}
+	return count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+}
+
+bool LidarSensor::MaskAngles(int first_angle, int last_angle)
+{
+	// while this sensor is being parsed its state is the parser's live state,
+	// which Feed saves once parsing returns
+	if (s_current == this)
+		return LidarParser_MaskAngles(first_angle, last_angle);
+
+	// while another sensor is being parsed, set its live state aside
+	if (s_current)
+		LidarParser_SaveState(s_current->parser_state.data());
+
+	LidarParser_RestoreState(parser_state.data());
+	bool masked = LidarParser_MaskAngles(first_angle, last_angle);
+	LidarParser_SaveState(parser_state.data());
+
+	if (s_current)
+		LidarParser_RestoreState(s_current->parser_state.data());
+	return masked;
+}
+
+void LidarSensor::SectorAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	waiting = handle;
+	sensor.sector_waiters.push_back(SectorWaiter{ handle, last_angle });
+}
+
+LidarSector LidarSensor::SectorAwaiter::await_resume()
+{
+	waiting = nullptr;
+
+	LidarSector sector;
+	sector.first_angle = first_angle;
+	sector.num_angles = (last_angle - first_angle + LidarScan_NUM_ANGLES) % LidarScan_NUM_ANGLES + 1;
+	for (int i = 0; i < sector.num_angles; ++i)
+		sector.distance[i] = sensor.latest.distance[(first_angle + i) % LidarScan_NUM_ANGLES];
+	return sector;
+}
+
+//==============================================================================
+// Resumes every coroutine in `waiters`. The list is first swapped with the
+// (empty) scratch list so that coroutines can wait again while being resumed;
+// the two lists trade their storage, so steady-state waiting never allocates.
+// Coroutines destroyed by an earlier one are cleared from the scratch list by
+// StopWaiting and skipped.
+//==============================================================================
+void LidarSensor::ResumeAll(std::vector<std::coroutine_handle<>> & waiters, std::vector<std::coroutine_handle<>> & scratch)
+{
+	scratch.swap(waiters);
+	for (size_t i = 0; i < scratch.size(); ++i)
+	{
+		if (scratch[i])
+			scratch[i].resume();
+	}
+	scratch.clear();
+}
+
+//==============================================================================
+// Forgets a coroutine that is destroyed while waiting, including one that is
+// about to be resumed.
+//==============================================================================
+void LidarSensor::StopWaiting(std::coroutine_handle<> handle)
+{
+	packet_waiters.erase(std::remove(packet_waiters.begin(), packet_waiters.end(), handle), packet_waiters.end());
+	scan_waiters.erase(std::remove(scan_waiters.begin(), scan_waiters.end(), handle), scan_waiters.end());
+	sector_waiters.erase(std::remove_if(sector_waiters.begin(), sector_waiters.end(),
+		[&](const SectorWaiter & waiter) { return waiter.handle == handle; }), sector_waiters.end());
+
+	std::replace(resuming.begin(), resuming.end(), handle, std::coroutine_handle<>());
+	for (auto & waiter : resuming_sectors)
+	{
+		if (waiter.handle == handle)
+			waiter.handle = nullptr;
+	}
+}
+
+//==============================================================================
+// Called for every measurement the parser emits. A full packet is delivered
+// at once; one shortened by the mask, and the end of a revolution, are only
+// known once the first measurement after them arrives.
+//==============================================================================
+void LidarSensor::OnMeasurement(int index, int distance)
+{
+	int previous_index = revolution.last_index;
+	bool new_revolution = LidarRevolution_Next(&revolution, index);
+	if (new_revolution || (packet.size > 0 && (packet.measurements[0].index >> 2) != (index >> 2)))
+		FlushPacket();
+	if (new_revolution)
+		CompleteScan();
+
+	latest.distance[index] = static_cast<uint16_t>(distance);
+	scans[1 - completed_scan].distance[index] = static_cast<uint16_t>(distance);
+	packet.measurements[packet.size++] = LidarMeasurement{ static_cast<uint16_t>(index), static_cast<uint16_t>(distance) };
+	++num_measurements;
+
+	ResumeSectors(previous_index, index, new_revolution);
+
+	if (packet.size == 4)
+		FlushPacket();
+}
+
+void LidarSensor::FlushPacket()
+{
+	if (packet.size == 0)
+		return;
+
+	ResumeAll(packet_waiters, resuming);
+	packet.size = 0;
+}
+
+void LidarSensor::CompleteScan()
+{
+	completed_scan = 1 - completed_scan;
+	std::fill(std::begin(scans[1 - completed_scan].distance), std::end(scans[1 - completed_scan].distance), 0);
+	ResumeAll(scan_waiters, resuming);
+}
+
+//==============================================================================
+// Resumes the sector waiters whose last angle was swept by the step from
+// previous_index to index (possibly across the end of a revolution).
+//==============================================================================
+void LidarSensor::ResumeSectors(int previous_index, int index, bool new_revolution)
+{
+	auto swept = [&](const SectorWaiter & waiter)
+	{
+		if (new_revolution)
+			return waiter.last_angle > previous_index || waiter.last_angle <= index;
+		return waiter.last_angle > previous_index && waiter.last_angle <= index;
+	};
+
+	auto first_swept = std::stable_partition(sector_waiters.begin(), sector_waiters.end(),
+		[&](const SectorWaiter & waiter) { return !swept(waiter); });
+	if (first_swept == sector_waiters.end())
+		return;
+
+	resuming_sectors.assign(first_swept, sector_waiters.end());
+	sector_waiters.erase(first_swept, sector_waiters.end());
+	for (size_t i = 0; i < resuming_sectors.size(); ++i)
+	{
+		if (resuming_sectors[i].handle)
+			resuming_sectors[i].handle.resume();
+	}
+	resuming_sectors.clear();
+}
+
+//==============================================================================
+// LidarEventLoop
+//==============================================================================
+
+void LidarEventLoop::Add(LidarSensor & sensor)
+{
+	sensors.push_back(&sensor);
+}
+
+void LidarEventLoop::Remove(LidarSensor & sensor)
+{
+	sensors.erase(std::remove(sensors.begin(), sensors.end(), &sensor), sensors.end());
+}
+
+bool LidarEventLoop::RunOnce(int timeout_ms)
+{
+	if (sensors.empty())
+		return false;
+
+	fds.clear();
+	for (LidarSensor * sensor : sensors)
+		fds.push_back(pollfd{ sensor->GetFd(), POLLIN, 0 });
+
+	int ready = poll(fds.data(), fds.size(), timeout_ms);
+	if (ready <= 0)
+		return true;
+
+	// snapshot the sensors, since resumed coroutines may add or remove (and
+	// destroy) some; a removed sensor is skipped rather than read
+	polled.assign(sensors.begin(), sensors.end());
+	for (size_t i = 0; i < fds.size(); ++i)
+	{
+		if (fds[i].revents == 0)
+			continue;
+		if (std::find(sensors.begin(), sensors.end(), polled[i]) == sensors.end())
+			continue;
+		if (!polled[i]->ReadAvailable())
+			Remove(*polled[i]);
+	}
+	return !sensors.empty();
+}
+
+void LidarEventLoop::Run()
+{
+	stopped = false;
+	while (!stopped && RunOnce(-1))
+		;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+// Builds a valid lidar packet for normalized angles 4 * packet_number ..
+// 4 * packet_number + 3, with the given distances.
+//==============================================================================
+std::vector<uint8_t> LidarPacketBuilder_Build(int packet_number, const uint16_t distances[4])
+{
+	std::vector<uint8_t> bytes(22, 0);
+	bytes[0] = 0xFA;
+	bytes[1] = static_cast<uint8_t>(0xA0 + packet_number);
+	bytes[2] = 0x35;
+	bytes[3] = 0x4b;
+	for (int i = 0; i < 4; ++i)
+	{
+		bytes[4 + 4 * i] = distances[i] & 0xFF;
+		bytes[5 + 4 * i] = (distances[i] >> 8) & 0x3F;
+	}
+
+	// same checksum as the lidar (and the parser) computes
+	uint32_t checksum = 0;
+	for (int i = 0; i < 10; ++i)
+		checksum = (checksum << 1) + bytes[2 * i] + (static_cast<uint16_t>(bytes[2 * i + 1]) << 8);
+	checksum = (checksum & 0x7FFF) + (checksum >> 15);
+	bytes[20] = checksum & 0xFF;
+	bytes[21] = (checksum >> 8) & 0xFF;
+	return bytes;
+}
+
+//==============================================================================
+// Builds a full revolution (90 packets) where every angle reads `distance`.
+//==============================================================================
+std::vector<uint8_t> LidarPacketBuilder_BuildRevolution(uint16_t distance)
+{
+	const uint16_t distances[4] = { distance, distance, distance, distance };
+	std::vector<uint8_t> bytes;
+	for (int packet = 0; packet < 90; ++packet)
+	{
+		std::vector<uint8_t> packet_bytes = LidarPacketBuilder_Build(packet, distances);
+		bytes.insert(bytes.end(), packet_bytes.begin(), packet_bytes.end());
+	}
+	return bytes;
+}
@@ -0,0 +1,4 @@
+#include "gtest/gtest.h"
+
+// Test Suites
+#include "LidarSensor_Tests.h"
\ No newline at end of file
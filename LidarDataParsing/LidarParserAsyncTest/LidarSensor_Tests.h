@@ -0,0 +1,277 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "LidarParserAsync.h"
+#include "LidarPacketBuilder.h"
+
+#include <optional>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+class LidarSensorTest : public testing::Test
+{
+protected:
+	const uint16_t distances[4] = { 100, 200, 300, 400 };
+};
+
+//==============================================================================
+// Verify that a coroutine awaiting the next packet receives every packet fed
+// to an in-memory sensor, including one split across two feeds.
+//==============================================================================
+TEST_F(LidarSensorTest, NextPacket_ReceivesEveryPacket)
+{
+	LidarSensor sensor;
+	std::vector<LidarPacketMeasurements> received;
+	auto consumer = [&]() -> LidarTask
+	{
+		for (int i = 0; i < 3; ++i)
+			received.push_back(co_await sensor.NextPacket());
+	};
+	LidarTask task = consumer();
+
+	std::vector<uint8_t> bytes;
+	for (int packet = 0; packet < 3; ++packet)
+	{
+		std::vector<uint8_t> packet_bytes = LidarPacketBuilder_Build(packet, distances);
+		bytes.insert(bytes.end(), packet_bytes.begin(), packet_bytes.end());
+	}
+	sensor.Feed(bytes.data(), 30);
+	EXPECT_EQ(1u, received.size());
+	sensor.Feed(bytes.data() + 30, bytes.size() - 30);
+
+	ASSERT_TRUE(task.Done());
+	ASSERT_EQ(3u, received.size());
+	EXPECT_EQ(4, received[2].size);
+	EXPECT_EQ(8, received[2].measurements[0].index);
+	EXPECT_EQ(400, received[2].measurements[3].distance);
+}
+
+//==============================================================================
+// Verify that repeated packets with the same index (as sent while the lidar is
+// spinning up) are each delivered as a packet of their own.
+//==============================================================================
+TEST_F(LidarSensorTest, NextPacket_DeliversRepeatedPacketsSeparately)
+{
+	LidarSensor sensor;
+	std::vector<LidarPacketMeasurements> received;
+	auto consumer = [&]() -> LidarTask
+	{
+		for (;;)
+			received.push_back(co_await sensor.NextPacket());
+	};
+	LidarTask task = consumer();
+
+	std::vector<uint8_t> bytes;
+	for (int i = 0; i < 3; ++i)
+	{
+		std::vector<uint8_t> packet_bytes = LidarPacketBuilder_Build(0, distances);
+		bytes.insert(bytes.end(), packet_bytes.begin(), packet_bytes.end());
+	}
+	sensor.Feed(bytes.data(), bytes.size());
+
+	ASSERT_EQ(3u, received.size());
+	for (const LidarPacketMeasurements & packet : received)
+	{
+		EXPECT_EQ(4, packet.size);
+		EXPECT_EQ(0, packet.measurements[0].index);
+		EXPECT_EQ(400, packet.measurements[3].distance);
+	}
+}
+
+//==============================================================================
+// Verify that destroying waiting tasks, including from inside another resumed
+// coroutine, stops them from being resumed.
+//==============================================================================
+TEST_F(LidarSensorTest, DestroyedTasksStopWaiting)
+{
+	LidarSensor sensor;
+	int resumed = 0;
+	auto waiter = [&]() -> LidarTask
+	{
+		co_await sensor.NextPacket();
+		++resumed;
+	};
+	std::optional<LidarTask> destroyed_by_other;
+	auto destroyer = [&]() -> LidarTask
+	{
+		co_await sensor.NextPacket();
+		destroyed_by_other.reset();
+	};
+
+	// the destroyer is resumed before the task it destroys
+	std::optional<LidarTask> destroyed_before_feed(waiter());
+	LidarTask task = destroyer();
+	destroyed_by_other.emplace(waiter());
+	destroyed_before_feed.reset();
+
+	std::vector<uint8_t> packet = LidarPacketBuilder_Build(0, distances);
+	sensor.Feed(packet.data(), packet.size());
+	sensor.Feed(packet.data(), packet.size());
+
+	EXPECT_TRUE(task.Done());
+	EXPECT_FALSE(destroyed_by_other.has_value());
+	EXPECT_EQ(0, resumed);
+}
+
+//==============================================================================
+// Verify that angles masked from a resumed coroutine take effect on the rest
+// of the bytes being parsed.
+//==============================================================================
+TEST_F(LidarSensorTest, MaskAngles_FromResumedCoroutineAppliesImmediately)
+{
+	LidarSensor sensor;
+	std::vector<LidarPacketMeasurements> received;
+	auto consumer = [&]() -> LidarTask
+	{
+		received.push_back(co_await sensor.NextPacket());
+		EXPECT_TRUE(sensor.MaskAngles(4, 7));
+		received.push_back(co_await sensor.NextPacket());
+	};
+	LidarTask task = consumer();
+
+	std::vector<uint8_t> bytes;
+	for (int packet = 0; packet < 3; ++packet)
+	{
+		std::vector<uint8_t> packet_bytes = LidarPacketBuilder_Build(packet, distances);
+		bytes.insert(bytes.end(), packet_bytes.begin(), packet_bytes.end());
+	}
+	sensor.Feed(bytes.data(), bytes.size());
+
+	ASSERT_TRUE(task.Done());
+	ASSERT_EQ(2u, received.size());
+	EXPECT_EQ(0, received[0].measurements[0].index);
+	EXPECT_EQ(8, received[1].measurements[0].index);
+}
+
+//==============================================================================
+// Verify that a sector is delivered once the lidar sweeps past its last angle.
+//==============================================================================
+TEST_F(LidarSensorTest, NextSector_ResumesAfterLastAngle)
+{
+	LidarSensor sensor;
+	bool resumed = false;
+	LidarSector sector{};
+	auto consumer = [&]() -> LidarTask
+	{
+		sector = co_await sensor.NextSector(2, 5);
+		resumed = true;
+	};
+	LidarTask task = consumer();
+
+	std::vector<uint8_t> packet_0 = LidarPacketBuilder_Build(0, distances);
+	std::vector<uint8_t> packet_1 = LidarPacketBuilder_Build(1, distances);
+	sensor.Feed(packet_0.data(), packet_0.size());
+	EXPECT_FALSE(resumed);
+	sensor.Feed(packet_1.data(), packet_1.size());
+
+	ASSERT_TRUE(resumed);
+	EXPECT_EQ(4, sector.num_angles);
+	EXPECT_EQ(300, sector.distance[0]);
+	EXPECT_EQ(400, sector.distance[1]);
+	EXPECT_EQ(100, sector.distance[2]);
+	EXPECT_EQ(200, sector.distance[3]);
+}
+
+//==============================================================================
+// Verify that two sensors fed from pipes through one event loop each deliver
+// their own scans, even with their bytes interleaved.
+//==============================================================================
+TEST_F(LidarSensorTest, EventLoop_TwoSensorsDeliverIndependentScans)
+{
+	int pipe_a[2];
+	int pipe_b[2];
+	ASSERT_EQ(0, pipe(pipe_a));
+	ASSERT_EQ(0, pipe(pipe_b));
+	fcntl(pipe_a[0], F_SETFL, O_NONBLOCK);
+	fcntl(pipe_b[0], F_SETFL, O_NONBLOCK);
+
+	LidarSensor sensor_a(pipe_a[0]);
+	LidarSensor sensor_b(pipe_b[0]);
+	LidarEventLoop loop;
+	loop.Add(sensor_a);
+	loop.Add(sensor_b);
+
+	uint16_t distance_a = 0;
+	uint16_t distance_b = 0;
+	auto consumer = [&](LidarSensor & sensor, uint16_t & distance) -> LidarTask
+	{
+		const LidarScan_t & scan = co_await sensor.NextScan();
+		distance = scan.distance[180];
+	};
+	LidarTask task_a = consumer(sensor_a, distance_a);
+	LidarTask task_b = consumer(sensor_b, distance_b);
+
+	// one revolution each, then the first packet of the next revolution to
+	// complete it
+	std::vector<uint8_t> bytes_a = LidarPacketBuilder_BuildRevolution(1111);
+	std::vector<uint8_t> bytes_b = LidarPacketBuilder_BuildRevolution(2222);
+	for (size_t offset = 0; offset < bytes_a.size(); offset += 100)
+	{
+		size_t count = std::min<size_t>(100, bytes_a.size() - offset);
+		ASSERT_EQ(static_cast<ssize_t>(count), write(pipe_a[1], bytes_a.data() + offset, count));
+		ASSERT_EQ(static_cast<ssize_t>(count), write(pipe_b[1], bytes_b.data() + offset, count));
+		loop.RunOnce(1000);
+		loop.RunOnce(0);
+	}
+	ASSERT_EQ(22, write(pipe_a[1], bytes_a.data(), 22));
+	ASSERT_EQ(22, write(pipe_b[1], bytes_b.data(), 22));
+
+	// closing the pipes ends the loop once both sensors reach end of file
+	close(pipe_a[1]);
+	close(pipe_b[1]);
+	loop.Run();
+
+	EXPECT_TRUE(task_a.Done());
+	EXPECT_TRUE(task_b.Done());
+	EXPECT_EQ(1111, distance_a);
+	EXPECT_EQ(2222, distance_b);
+	close(pipe_a[0]);
+	close(pipe_b[0]);
+}
+
+//==============================================================================
+// Verify that a sensor removed and destroyed by a coroutine resumed in the same
+// dispatch is not read afterwards, even though its descriptor was ready.
+//==============================================================================
+TEST_F(LidarSensorTest, EventLoop_SensorDestroyedByCoroutineIsNotRead)
+{
+	int pipe_a[2];
+	int pipe_b[2];
+	ASSERT_EQ(0, pipe(pipe_a));
+	ASSERT_EQ(0, pipe(pipe_b));
+	fcntl(pipe_a[0], F_SETFL, O_NONBLOCK);
+	fcntl(pipe_b[0], F_SETFL, O_NONBLOCK);
+
+	LidarSensor sensor_a(pipe_a[0]);
+	std::optional<LidarSensor> sensor_b(std::in_place, pipe_b[0]);
+	LidarEventLoop loop;
+	loop.Add(sensor_a);
+	loop.Add(*sensor_b);
+
+	auto destroyer = [&]() -> LidarTask
+	{
+		co_await sensor_a.NextPacket();
+		loop.Remove(*sensor_b);
+		sensor_b.reset();
+	};
+	LidarTask task = destroyer();
+
+	// both descriptors are ready when the loop polls them
+	std::vector<uint8_t> packet = LidarPacketBuilder_Build(0, distances);
+	ASSERT_EQ(static_cast<ssize_t>(packet.size()), write(pipe_a[1], packet.data(), packet.size()));
+	ASSERT_EQ(static_cast<ssize_t>(packet.size()), write(pipe_b[1], packet.data(), packet.size()));
+	EXPECT_TRUE(loop.RunOnce(1000));
+
+	EXPECT_TRUE(task.Done());
+	EXPECT_FALSE(sensor_b.has_value());
+
+	// the unread bytes are still in the destroyed sensor's pipe
+	uint8_t unread[64];
+	EXPECT_EQ(static_cast<ssize_t>(packet.size()), read(pipe_b[0], unread, sizeof(unread)));
+
+	close(pipe_a[1]);
+	close(pipe_b[1]);
+	close(pipe_a[0]);
+	close(pipe_b[0]);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "LidarParser.h"
+#include "ReferenceLidarParser.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+//==============================================================================
+// Differential Harness
+//
+// Feeds one byte stream to the production parser, split into chunks with a
+// LidarParser_Parse call after each, and to the reference parser in one
+// piece. The two must produce identical measurements.
+//==============================================================================
+
+struct DifferentialCase
+{
+	std::vector<uint8_t> stream;
+
+	// number of bytes made available before each call to LidarParser_Parse
+	std::vector<size_t> chunk_sizes;
+
+	// optional masked range of angles
+	bool masked = false;
+	int mask_first = 0;
+	int mask_last = 0;
+};
+
+static const uint8_t * s_harness_input;
+static const uint8_t * s_harness_input_end;
+static std::vector<ReferenceMeasurement_t> s_harness_output;
+
+uint8_t DifferentialHarness_GetByte()
+{
+	return *s_harness_input++;
+}
+
+bool DifferentialHarness_IsEmpty()
+{
+	return s_harness_input == s_harness_input_end;
+}
+
+void DifferentialHarness_AddMeasurement(uint16_t index, uint16_t distance)
+{
+	s_harness_output.emplace_back(index, distance);
+}
+
+int DifferentialHarness_GetSize()
+{
+	return static_cast<int>(s_harness_output.size());
+}
+
+std::vector<ReferenceMeasurement_t> DifferentialHarness_RunProduction(const DifferentialCase & test_case)
+{
+	static LidarInputStream_i stream = { DifferentialHarness_GetByte, DifferentialHarness_IsEmpty };
+	static LidarMeasurementBuffer_i buffer = { DifferentialHarness_AddMeasurement, DifferentialHarness_GetSize };
+
+	s_harness_output.clear();
+	LidarParser_Init(&stream, &buffer);
+	if (test_case.masked)
+		LidarParser_MaskAngles(test_case.mask_first, test_case.mask_last);
+
+	const uint8_t * next = test_case.stream.data();
+	const uint8_t * end = next + test_case.stream.size();
+	for (size_t chunk_size : test_case.chunk_sizes)
+	{
+		s_harness_input = next;
+		s_harness_input_end = next + std::min<size_t>(chunk_size, end - next);
+		LidarParser_Parse();
+		next = s_harness_input_end;
+	}
+
+	// whatever is left over arrives in one final chunk
+	s_harness_input = next;
+	s_harness_input_end = end;
+	LidarParser_Parse();
+
+	return s_harness_output;
+}
+
+std::vector<ReferenceMeasurement_t> DifferentialHarness_RunReference(const DifferentialCase & test_case)
+{
+	std::bitset<360> mask;
+	if (test_case.masked)
+	{
+		for (int angle = test_case.mask_first; ; angle = (angle + 1) % 360)
+		{
+			mask.set(angle);
+			if (angle == test_case.mask_last)
+				break;
+		}
+	}
+	return ReferenceLidarParser_Parse(test_case.stream, mask);
+}
+
+//==============================================================================
+// Splits `size` bytes into random chunks of 0 to max_chunk bytes.
+//==============================================================================
+std::vector<size_t> DifferentialHarness_RandomChunks(std::mt19937 & random, size_t size, size_t max_chunk)
+{
+	std::uniform_int_distribution<size_t> chunk(0, max_chunk);
+	std::vector<size_t> chunk_sizes;
+	for (size_t total = 0; total < size; )
+	{
+		chunk_sizes.push_back(chunk(random));
+		total += chunk_sizes.back();
+	}
+	return chunk_sizes;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "DifferentialHarness.h"
+
+#include <random>
+
+class Differential : public testing::Test
+{
+protected:
+	std::mt19937 random{ 20181018 };
+
+	uint8_t RandomByte()
+	{
+		return static_cast<uint8_t>(std::uniform_int_distribution<int>(0, 255)(random));
+	}
+
+	int RandomInt(int min, int max)
+	{
+		return std::uniform_int_distribution<int>(min, max)(random);
+	}
+
+	// a packet with a random index, random data (including the flag bits) and
+	// a correct checksum
+	std::vector<uint8_t> RandomValidPacket()
+	{
+		std::vector<uint8_t> packet(22);
+		packet[0] = 0xFA;
+		packet[1] = static_cast<uint8_t>(0xA0 + RandomInt(0, 89));
+		for (int i = 2; i < 20; ++i)
+			packet[i] = RandomByte();
+
+		uint32_t checksum = 0;
+		for (int i = 0; i < 10; ++i)
+			checksum = (checksum << 1) + packet[2 * i] + (static_cast<uint16_t>(packet[2 * i + 1]) << 8);
+		checksum = (checksum & 0x7FFF) + (checksum >> 15);
+		packet[20] = checksum & 0xFF;
+		packet[21] = (checksum >> 8) & 0xFF;
+		return packet;
+	}
+
+	// a stream of valid packets, damaged packets and noise biased towards
+	// start bytes and valid index bytes
+	std::vector<uint8_t> RandomStream(int num_segments)
+	{
+		std::vector<uint8_t> stream;
+		for (int segment = 0; segment < num_segments; ++segment)
+		{
+			std::vector<uint8_t> bytes;
+			switch (RandomInt(0, 4))
+			{
+			case 0:
+			case 1:
+				bytes = RandomValidPacket();
+				break;
+			case 2:
+				bytes = RandomValidPacket();
+				bytes[RandomInt(0, 21)] ^= static_cast<uint8_t>(RandomInt(1, 255));
+				break;
+			case 3:
+				bytes = RandomValidPacket();
+				bytes.resize(RandomInt(1, 21));
+				break;
+			case 4:
+				for (int i = RandomInt(1, 30); i > 0; --i)
+				{
+					int kind = RandomInt(0, 3);
+					bytes.push_back(kind == 0 ? 0xFA : kind == 1 ? static_cast<uint8_t>(0xA0 + RandomInt(0, 95)) : RandomByte());
+				}
+				break;
+			}
+			stream.insert(stream.end(), bytes.begin(), bytes.end());
+		}
+		return stream;
+	}
+
+	void ExpectSameOutput(const DifferentialCase & test_case)
+	{
+		std::vector<ReferenceMeasurement_t> expected = DifferentialHarness_RunReference(test_case);
+		std::vector<ReferenceMeasurement_t> actual = DifferentialHarness_RunProduction(test_case);
+		ASSERT_EQ(expected, actual) << "stream of " << test_case.stream.size() << " bytes in " << test_case.chunk_sizes.size() << " chunks";
+	}
+};
+
+//==============================================================================
+// Verify that the generated streams actually contain packets the parser
+// accepts, so the comparisons below are meaningful.
+//==============================================================================
+TEST_F(Differential, GeneratedStreamsContainValidPackets)
+{
+	DifferentialCase test_case;
+	test_case.stream = RandomStream(200);
+	EXPECT_GT(DifferentialHarness_RunReference(test_case).size(), 100u);
+}
+
+//==============================================================================
+// Verify that random streams parsed in one piece match the reference.
+//==============================================================================
+TEST_F(Differential, RandomStreams_SingleChunk)
+{
+	for (int i = 0; i < 500; ++i)
+	{
+		DifferentialCase test_case;
+		test_case.stream = RandomStream(RandomInt(1, 40));
+		ExpectSameOutput(test_case);
+	}
+}
+
+//==============================================================================
+// Verify that random streams split at random chunk boundaries, including
+// chunks larger than the parsing buffer and empty chunks, match the
+// reference.
+//==============================================================================
+TEST_F(Differential, RandomStreams_RandomChunks)
+{
+	for (int i = 0; i < 2000; ++i)
+	{
+		DifferentialCase test_case;
+		test_case.stream = RandomStream(RandomInt(1, 40));
+		size_t max_chunk = std::vector<size_t>{ 1, 7, 23, 64, 500 }[RandomInt(0, 4)];
+		test_case.chunk_sizes = DifferentialHarness_RandomChunks(random, test_case.stream.size(), max_chunk);
+		ExpectSameOutput(test_case);
+	}
+}
+
+//==============================================================================
+// Verify that masking matches the reference for random masked ranges.
+//==============================================================================
+TEST_F(Differential, RandomStreams_RandomMasks)
+{
+	for (int i = 0; i < 1000; ++i)
+	{
+		DifferentialCase test_case;
+		test_case.stream = RandomStream(RandomInt(1, 40));
+		test_case.chunk_sizes = DifferentialHarness_RandomChunks(random, test_case.stream.size(), 64);
+		test_case.masked = true;
+		test_case.mask_first = RandomInt(0, 359);
+		test_case.mask_last = RandomInt(0, 359);
+		ExpectSameOutput(test_case);
+	}
+}
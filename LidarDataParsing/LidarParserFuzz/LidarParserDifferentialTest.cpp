@@ -0,0 +1,4 @@
+#include "gtest/gtest.h"
+
+// Test Suites
+#include "Differential_Tests.h"
\ No newline at end of file
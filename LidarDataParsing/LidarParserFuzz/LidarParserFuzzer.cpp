@@ -0,0 +1,36 @@
+//==============================================================================
+// libFuzzer entry point for differential fuzzing of the parser against the
+// reference parser. Built with -DLIDAR_PARSER_FUZZ=ON using clang; run
+// locally, e.g.
+//
+//     ./LidarParserFuzzer -max_len=4096 corpus/
+//
+// Input layout: 4 bytes seed for the chunk boundaries, 1 byte mask flag,
+// 2 bytes masked range, then the byte stream.
+//==============================================================================
+
+#include "DifferentialHarness.h"
+
+#include <cstdlib>
+#include <random>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+	const size_t control_size = 7;
+	if (size < control_size)
+		return 0;
+
+	DifferentialCase test_case;
+	uint32_t seed = data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+	test_case.masked = data[4] & 1;
+	test_case.mask_first = data[5] * 360 / 256;
+	test_case.mask_last = data[6] * 360 / 256;
+	test_case.stream.assign(data + control_size, data + size);
+
+	std::mt19937 random(seed);
+	test_case.chunk_sizes = DifferentialHarness_RandomChunks(random, test_case.stream.size(), 64);
+
+	if (DifferentialHarness_RunProduction(test_case) != DifferentialHarness_RunReference(test_case))
+		std::abort();
+	return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+//==============================================================================
+// Reference Lidar Parser
+//
+// A frozen, deliberately simple restatement of the parser's behavior, used as
+// the oracle for differential testing. The packet validation below is a copy
+// of the original Packet.c logic and must not be optimized or "fixed"; any
+// change in the production parser's output relative to it is a regression
+// (or an intended behavior change that must be made here as well).
+//
+// Given the complete byte stream, the parser:
+//  - skips bytes until a start byte (0xFA),
+//  - waits if fewer than 22 bytes remain from the start byte,
+//  - drops only the start byte if the packet is invalid,
+//  - otherwise emits the unmasked measurements and drops the whole packet,
+//    reporting readings flagged invalid (bit 15) as distance 0.
+//==============================================================================
+
+typedef std::tuple<uint16_t, uint16_t> ReferenceMeasurement_t;
+
+bool ReferenceLidarParser_IsValid(const uint8_t * packet_bytes)
+{
+	// validate the index
+	if (!(packet_bytes[1] >= 0xA0 && packet_bytes[1] <= 0xF9))
+		return false;
+
+	// combine the bytes into 16 bit values
+	uint16_t combined[10];
+	for (int i = 0; i < 10; ++i)
+		combined[i] = packet_bytes[2 * i] + ((uint16_t)packet_bytes[2 * i + 1] << 8);
+
+	// compute the checksum
+	uint32_t checksum = 0;
+	for (int i = 0; i < 10; ++i)
+		checksum = (checksum << 1) + combined[i];
+	checksum = (checksum & 0x7FFF) + (checksum >> 15);
+
+	// truncate the result to 15 bits
+	uint16_t calculated_checksum = checksum & 0x7FFFF;
+
+	uint16_t packet_checksum = packet_bytes[20] + ((uint16_t)packet_bytes[21] << 8);
+	return packet_checksum == calculated_checksum;
+}
+
+std::vector<ReferenceMeasurement_t> ReferenceLidarParser_Parse(const std::vector<uint8_t> & bytes, const std::bitset<360> & mask)
+{
+	const size_t packet_size = 22;
+	std::vector<ReferenceMeasurement_t> measurements;
+
+	size_t position = 0;
+	while (position < bytes.size())
+	{
+		if (bytes[position] != 0xFA)
+		{
+			++position;
+			continue;
+		}
+		if (bytes.size() - position < packet_size)
+			break;
+
+		const uint8_t * packet_bytes = &bytes[position];
+		if (!ReferenceLidarParser_IsValid(packet_bytes))
+		{
+			++position;
+			continue;
+		}
+
+		for (int j = 0; j < 4; ++j)
+		{
+			uint16_t index = static_cast<uint16_t>(((packet_bytes[1] - 0xA0) << 2) + j);
+			uint16_t lsb = packet_bytes[4 + 4 * j];
+			uint16_t msb = packet_bytes[5 + 4 * j];
+			uint16_t distance = (msb & 0x80) ? 0 : (lsb + (msb << 8)) & ~(1 << 14 | 1 << 15);
+			if (!mask[index])
+				measurements.emplace_back(index, distance);
+		}
+		position += packet_size;
+	}
+	return measurements;
+}
@@ -4,3 +4,11 @@
 #include "LidarParser_NoInput_Tests.h"
 #include "LidarParser_ValidInput_Tests.h"
 #include "LidarParser_InvalidInput_Tests.h"
+#include "LidarParser_Masking_Tests.h"
+#include "ScanFilter_Tests.h"
+#include "TemporalFilter_Tests.h"
+#include "ScanFusion_Tests.h"
+#include "ObstacleIndex_Tests.h"
+#include "ScanFramePool_Tests.h"
+#include "LidarTrace_Tests.h"
+#include "ScanLog_Tests.h"
\ No newline at end of file
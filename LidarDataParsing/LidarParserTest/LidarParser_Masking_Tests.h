@@ -0,0 +1,79 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "LidarParser.h"
+
+// reuses the valid packets and mock configuration
+#include "LidarParser_ValidInput_Tests.h"
+
+class LidarParser_Masking : public LidarParser_ValidInput
+{
+};
+
+//==============================================================================
+// Verify that a packet whose angles are all masked adds no measurements, and
+// that the following packet is still parsed.
+//==============================================================================
+TEST_F(LidarParser_Masking, FullyMaskedPacketIsDropped)
+{
+	LidarParser_MaskAngles(0, 3);
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	MockLidarInputStream_AddBytes(valid_packet_1);
+	LidarParser_Parse();
+	EXPECT_EQ(4, message_buffer.GetSize());
+	EXPECT_EQ(4, MockLidarMeasurementBuffer_GetIndex(0));
+}
+
+//==============================================================================
+// Verify that only the masked measurements of a partially masked packet are
+// dropped.
+//==============================================================================
+TEST_F(LidarParser_Masking, PartiallyMaskedPacketAddsUnmaskedMeasurements)
+{
+	LidarParser_MaskAngles(1, 2);
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+	EXPECT_EQ(2, message_buffer.GetSize());
+	EXPECT_EQ(0, MockLidarMeasurementBuffer_GetIndex(0));
+	EXPECT_EQ(3, MockLidarMeasurementBuffer_GetIndex(1));
+}
+
+//==============================================================================
+// Verify that a masked range wraps around at 360 degrees.
+//==============================================================================
+TEST_F(LidarParser_Masking, MaskWrapsAround)
+{
+	LidarParser_MaskAngles(358, 4);
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	MockLidarInputStream_AddBytes(valid_packet_1);
+	LidarParser_Parse();
+	EXPECT_EQ(3, message_buffer.GetSize());
+	EXPECT_EQ(5, MockLidarMeasurementBuffer_GetIndex(0));
+}
+
+//==============================================================================
+// Verify that clearing the mask restores all measurements.
+//==============================================================================
+TEST_F(LidarParser_Masking, ClearMaskRestoresMeasurements)
+{
+	LidarParser_MaskAngles(0, 359);
+	LidarParser_ClearMask();
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+	EXPECT_EQ(4, message_buffer.GetSize());
+}
+
+//==============================================================================
+// Verify that out-of-range angles are rejected without changing the mask.
+//==============================================================================
+TEST_F(LidarParser_Masking, OutOfRangeAnglesAreRejected)
+{
+	EXPECT_FALSE(LidarParser_MaskAngles(0, 360));
+	EXPECT_FALSE(LidarParser_MaskAngles(-1, 3));
+	EXPECT_FALSE(LidarParser_MaskAngles(400, 3));
+	EXPECT_TRUE(LidarParser_MaskAngles(359, 359));
+
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+	EXPECT_EQ(4, message_buffer.GetSize());
+}
@@ -113,6 +113,21 @@ TEST_F(LidarParser_ValidInput, TwoValidPackets_CorrectDistances)
 	EXPECT_EQ(0x019b, MockLidarMeasurementBuffer_GetDistance(7));
 }
 
+//==============================================================================
+// Verify that readings with the invalid data flag set are passed into the
+// measurement buffer as distance 0 rather than as their error code.
+//==============================================================================
+TEST_F(LidarParser_ValidInput, OneValidPacket_InvalidReadingsAreZero)
+{
+	MockLidarInputStream_AddBytes(valid_packet_6);
+	LidarParser_Parse();
+	ASSERT_EQ(4, message_buffer.GetSize());
+	EXPECT_EQ(0, MockLidarMeasurementBuffer_GetDistance(0));
+	EXPECT_EQ(0x0179, MockLidarMeasurementBuffer_GetDistance(1));
+	EXPECT_EQ(0, MockLidarMeasurementBuffer_GetDistance(2));
+	EXPECT_EQ(0x0161, MockLidarMeasurementBuffer_GetDistance(3));
+}
+
 //==============================================================================
 // Verify that the correct indices are passed into the measurement buffer
 // when a single valid packet is received.
@@ -161,3 +176,35 @@ TEST_F(LidarParser_ValidInput, MultipleValidPacketsSurroundedByTrashBytes)
 	// verify correct number of measurements were parsed
 	EXPECT_EQ(12, message_buffer.GetSize());
 }
+
+//==============================================================================
+// Verify that all packets are parsed when the stream holds more bytes than
+// fit in the parsing buffer at once.
+//==============================================================================
+TEST_F(LidarParser_ValidInput, StreamLargerThanParsingBuffer)
+{
+	for (int i = 0; i < 20; ++i)
+		MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+	EXPECT_EQ(80, message_buffer.GetSize());
+}
+
+//==============================================================================
+// Verify that a packet split across two calls to LidarParser_Parse is parsed
+// once its remaining bytes arrive.
+//==============================================================================
+TEST_F(LidarParser_ValidInput, PacketSplitAcrossParseCalls)
+{
+	std::deque<uint8_t> first_half(valid_packet_1.begin(), valid_packet_1.begin() + 10);
+	std::deque<uint8_t> second_half(valid_packet_1.begin() + 10, valid_packet_1.end());
+
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	MockLidarInputStream_AddBytes(first_half);
+	LidarParser_Parse();
+	EXPECT_EQ(4, message_buffer.GetSize());
+
+	MockLidarInputStream_AddBytes(second_half);
+	LidarParser_Parse();
+	EXPECT_EQ(8, message_buffer.GetSize());
+	EXPECT_EQ(0x019b, MockLidarMeasurementBuffer_GetDistance(7));
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#ifdef LIDAR_PARSER_TRACE
+
+#include "gtest/gtest.h"
+#include "LidarParser.h"
+#include "LidarTrace.h"
+
+// reuses the valid packets and mock configuration
+#include "LidarParser_ValidInput_Tests.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+class LidarTrace : public LidarParser_ValidInput
+{
+protected:
+	std::string Dump()
+	{
+		FILE * file = std::tmpfile();
+		LidarTrace_Dump(file);
+		std::string json(static_cast<size_t>(std::ftell(file)), '\0');
+		std::rewind(file);
+		size_t length = std::fread(&json[0], 1, json.size(), file);
+		std::fclose(file);
+		json.resize(length);
+		return json;
+	}
+
+	static size_t Count(const std::string & text, const std::string & pattern)
+	{
+		size_t count = 0;
+		for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+			++count;
+		return count;
+	}
+};
+
+//==============================================================================
+// Verify that parsing a packet records balanced spans for the stages and the
+// measurement buffer calls.
+//==============================================================================
+TEST_F(LidarTrace, ParsingRecordsStageSpans)
+{
+	LidarTrace_Clear();
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+
+	std::string json = Dump();
+	EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+	EXPECT_EQ(1u, Count(json, "\"Handler_ValidatingPacket\",\"ph\":\"B\""));
+	EXPECT_EQ(1u, Count(json, "\"Handler_ValidatingPacket\",\"ph\":\"E\""));
+	EXPECT_EQ(4u, Count(json, "\"AddMeasurement\",\"ph\":\"B\""));
+	EXPECT_EQ(Count(json, "\"ph\":\"B\""), Count(json, "\"ph\":\"E\""));
+}
+
+//==============================================================================
+// Verify that clearing the trace discards recorded events.
+//==============================================================================
+TEST_F(LidarTrace, ClearDiscardsEvents)
+{
+	MockLidarInputStream_AddBytes(valid_packet_0);
+	LidarParser_Parse();
+	LidarTrace_Clear();
+	EXPECT_EQ(0u, Count(Dump(), "\"ph\""));
+}
+
+//==============================================================================
+// Verify that once the ring wraps, the ends of spans whose beginnings were
+// overwritten are left out of the dump.
+//==============================================================================
+TEST_F(LidarTrace, WrappedRingDropsUnmatchedEnds)
+{
+	LidarTrace_Clear();
+	LidarTrace_Begin("outer");
+	for (int i = 0; i < LidarTrace_RING_SIZE / 2; ++i)
+	{
+		LidarTrace_Begin("inner");
+		LidarTrace_End("inner");
+	}
+	LidarTrace_End("outer");
+
+	// the two oldest events, "outer" and the first "inner" beginning, are gone
+	std::string json = Dump();
+	EXPECT_EQ(0u, Count(json, "\"outer\""));
+	EXPECT_EQ(LidarTrace_RING_SIZE / 2 - 1u, Count(json, "\"inner\",\"ph\":\"B\""));
+	EXPECT_EQ(Count(json, "\"ph\":\"B\""), Count(json, "\"ph\":\"E\""));
+}
+
+//==============================================================================
+// Verify that threads started after every ring has been claimed are counted
+// as dropped instead of being traced.
+//==============================================================================
+TEST_F(LidarTrace, ThreadsBeyondMaximumAreCounted)
+{
+	LidarTrace_Clear();
+	LidarTrace_Begin("main");
+	LidarTrace_End("main");
+
+	// with the main thread holding a ring, at least one of these finds none
+	int dropped_before = LidarTrace_GetDroppedThreadCount();
+	for (int i = 0; i < LidarTrace_MAX_THREADS; ++i)
+	{
+		std::thread thread([] { LidarTrace_Begin("worker"); LidarTrace_End("worker"); });
+		thread.join();
+	}
+	int dropped = LidarTrace_GetDroppedThreadCount() - dropped_before;
+
+	EXPECT_GE(dropped, 1);
+	EXPECT_EQ(2u * (LidarTrace_MAX_THREADS - dropped), Count(Dump(), "\"worker\""));
+}
+
+#endif // LIDAR_PARSER_TRACE
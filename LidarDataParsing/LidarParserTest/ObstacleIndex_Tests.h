@@ -0,0 +1,108 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "ObstacleIndex.h"
+#include "LidarParser.h"
+
+// mock implementations
+#include "MockLidarInputStream.h"
+
+class ObstacleIndex : public testing::Test
+{
+protected:
+	int angle;
+
+	void SetUp()
+	{
+		ObstacleIndex_Init();
+		for (uint16_t i = 0; i < LidarScan_NUM_ANGLES; ++i)
+			ObstacleIndex_AddMeasurement(i, 1000 + i);
+	}
+};
+
+//==============================================================================
+// Verify that the nearest return within a range is found along with its angle.
+//==============================================================================
+TEST_F(ObstacleIndex, FindsNearestInRange)
+{
+	ObstacleIndex_AddMeasurement(50, 300);
+	EXPECT_EQ(300, ObstacleIndex_FindNearest(10, 90, &angle));
+	EXPECT_EQ(50, angle);
+	EXPECT_EQ(1091, ObstacleIndex_FindNearest(91, 200, &angle));
+	EXPECT_EQ(91, angle);
+}
+
+//==============================================================================
+// Verify that ranges wrap around past 359 degrees.
+//==============================================================================
+TEST_F(ObstacleIndex, RangeWrapsAround)
+{
+	ObstacleIndex_AddMeasurement(355, 200);
+	EXPECT_EQ(200, ObstacleIndex_FindNearest(350, 10, &angle));
+	EXPECT_EQ(355, angle);
+	EXPECT_EQ(1000, ObstacleIndex_FindNearest(357, 10, &angle));
+	EXPECT_EQ(0, angle);
+}
+
+//==============================================================================
+// Verify that newer measurements replace older ones, and that a reading with
+// no return removes the angle.
+//==============================================================================
+TEST_F(ObstacleIndex, UpdatesReplaceOlderMeasurements)
+{
+	ObstacleIndex_AddMeasurement(20, 100);
+	ObstacleIndex_AddMeasurement(20, 5000);
+	EXPECT_EQ(1021, ObstacleIndex_FindNearest(20, 21, &angle));
+	EXPECT_EQ(21, angle);
+
+	ObstacleIndex_AddMeasurement(30, 0);
+	EXPECT_EQ(0, ObstacleIndex_FindNearest(30, 30, &angle));
+	EXPECT_EQ(-1, angle);
+}
+
+//==============================================================================
+// Verify that the first and last angles are covered by a full-circle query.
+//==============================================================================
+TEST_F(ObstacleIndex, FullRangeCoversEveryAngle)
+{
+	EXPECT_EQ(1000, ObstacleIndex_FindNearest(0, 359, &angle));
+	EXPECT_EQ(0, angle);
+	ObstacleIndex_AddMeasurement(359, 1);
+	EXPECT_EQ(1, ObstacleIndex_FindNearest(0, 359, &angle));
+	EXPECT_EQ(359, angle);
+}
+
+//==============================================================================
+// Verify that ranges outside 0..359 report no return instead of reading past
+// the index.
+//==============================================================================
+TEST_F(ObstacleIndex, OutOfRangeAnglesFindNothing)
+{
+	angle = 0;
+	EXPECT_EQ(0, ObstacleIndex_FindNearest(-1, 10, &angle));
+	EXPECT_EQ(-1, angle);
+	angle = 0;
+	EXPECT_EQ(0, ObstacleIndex_FindNearest(10, 360, &angle));
+	EXPECT_EQ(-1, angle);
+	angle = 0;
+	EXPECT_EQ(0, ObstacleIndex_FindNearest(400, 500, &angle));
+	EXPECT_EQ(-1, angle);
+}
+
+//==============================================================================
+// Verify that the index can be fed directly by the parser.
+//==============================================================================
+TEST_F(ObstacleIndex, FedByParser)
+{
+	LidarInputStream_i input_stream = { MockLidarInputStream_GetByte, MockLidarInputStream_IsEmpty };
+	LidarMeasurementBuffer_i index = { ObstacleIndex_AddMeasurement, ObstacleIndex_GetSize };
+	ObstacleIndex_Init();
+	MockLidarInputStream_Reset();
+	MockLidarInputStream_AddBytes({ 0xfa, 0xa0, 0x27, 0x4b, 0x97, 0x01, 0xbb, 0x01, 0x97, 0x01, 0xb4, 0x00, 0x98, 0x01, 0x53, 0x00, 0x99, 0x01, 0x93, 0x00, 0x4e, 0x28 });
+	LidarParser_Init(&input_stream, &index);
+	LidarParser_Parse();
+
+	EXPECT_EQ(4, ObstacleIndex_GetSize());
+	EXPECT_EQ(0x0197, ObstacleIndex_FindNearest(0, 359, &angle));
+	EXPECT_EQ(0, angle);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "ScanFilter.h"
+
+class ScanFilter : public testing::Test
+{
+protected:
+	LidarScan_t in;
+	LidarScan_t out;
+
+	void SetUp()
+	{
+		// a flat wall at constant distance
+		for (int i = 0; i < LidarScan_NUM_ANGLES; ++i)
+			in.distance[i] = 1000;
+	}
+};
+
+//==============================================================================
+// Verify that the median filter removes a single spike and fills a single
+// missing reading, including at the wrap-around angles.
+//==============================================================================
+TEST_F(ScanFilter, Median_RemovesSpikeAndFillsDropout)
+{
+	in.distance[10] = 4000;
+	in.distance[20] = 0;
+	in.distance[0] = 4000;
+	ScanFilter_Median(&in, &out);
+	EXPECT_EQ(1000, out.distance[10]);
+	EXPECT_EQ(1000, out.distance[20]);
+	EXPECT_EQ(1000, out.distance[0]);
+	EXPECT_EQ(1000, out.distance[359]);
+}
+
+//==============================================================================
+// Verify that isolated points are rejected while points that agree with at
+// least one neighbor are kept.
+//==============================================================================
+TEST_F(ScanFilter, RejectOutliers_RemovesOnlyIsolatedPoints)
+{
+	in.distance[100] = 3000;
+	in.distance[200] = 3000;
+	in.distance[201] = 3010;
+	in.distance[359] = 50;
+	ScanFilter_RejectOutliers(&in, &out, 100);
+	EXPECT_EQ(0, out.distance[100]);
+	EXPECT_EQ(3000, out.distance[200]);
+	EXPECT_EQ(3010, out.distance[201]);
+	EXPECT_EQ(0, out.distance[359]);
+	EXPECT_EQ(1000, out.distance[0]);
+}
+
+//==============================================================================
+// Verify that downsampling keeps the nearest return of each bin and ignores
+// missing readings.
+//==============================================================================
+TEST_F(ScanFilter, Downsample_KeepsNearestReturnPerBin)
+{
+	uint16_t bins[LidarScan_NUM_ANGLES];
+	in.distance[5] = 300;
+	in.distance[6] = 0;
+	for (int i = 10; i < 20; ++i)
+		in.distance[i] = 0;
+
+	ASSERT_EQ(36, ScanFilter_Downsample(&in, 10, bins));
+	EXPECT_EQ(300, bins[0]);
+	EXPECT_EQ(0, bins[1]);
+	EXPECT_EQ(1000, bins[2]);
+}
+
+//==============================================================================
+// Verify that a factor which does not divide the scan is rejected.
+//==============================================================================
+TEST_F(ScanFilter, Downsample_InvalidFactor)
+{
+	uint16_t bins[LidarScan_NUM_ANGLES];
+	EXPECT_EQ(0, ScanFilter_Downsample(&in, 7, bins));
+	EXPECT_EQ(0, ScanFilter_Downsample(&in, 0, bins));
+}
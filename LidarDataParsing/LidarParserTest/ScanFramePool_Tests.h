@@ -0,0 +1,116 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "ScanFramePool.h"
+
+#include <vector>
+
+static std::vector<const ScanFrame_t *> s_retained_frames;
+static int s_frames_seen;
+
+void RetainingConsumer(const ScanFrame_t * frame)
+{
+	ScanFramePool_Retain(frame);
+	s_retained_frames.push_back(frame);
+}
+
+void CountingConsumer(const ScanFrame_t *)
+{
+	++s_frames_seen;
+}
+
+class ScanFramePool : public testing::Test
+{
+protected:
+	void SetUp()
+	{
+		ScanFramePool_Init();
+		s_retained_frames.clear();
+		s_frames_seen = 0;
+	}
+
+	// feeds a revolution with a few measurements; the first measurement of the
+	// following revolution completes it
+	void AddRevolution(uint16_t distance)
+	{
+		for (uint16_t i = 0; i < 10; ++i)
+			ScanFramePool_AddMeasurement(i, distance);
+	}
+};
+
+//==============================================================================
+// Verify that every consumer receives each completed frame, and that frames
+// nobody retains go straight back to the pool.
+//==============================================================================
+TEST_F(ScanFramePool, CompletedFrameGoesToEveryConsumer)
+{
+	ScanFramePool_AddConsumer(CountingConsumer);
+	ScanFramePool_AddConsumer(CountingConsumer);
+	AddRevolution(100);
+	AddRevolution(200);
+	AddRevolution(300);
+
+	EXPECT_EQ(4, s_frames_seen);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 1, ScanFramePool_GetFreeCount());
+	EXPECT_EQ(0u, ScanFramePool_GetExhaustedCount());
+}
+
+//==============================================================================
+// Verify that a retained frame keeps its contents and returns to the pool when
+// the last reference is released.
+//==============================================================================
+TEST_F(ScanFramePool, RetainedFrameReturnsOnLastRelease)
+{
+	ScanFramePool_AddConsumer(RetainingConsumer);
+	AddRevolution(100);
+	AddRevolution(200);
+
+	ASSERT_EQ(1u, s_retained_frames.size());
+	const ScanFrame_t * frame = s_retained_frames[0];
+	EXPECT_EQ(0u, frame->sequence);
+	EXPECT_EQ(10, frame->num_measurements);
+	EXPECT_EQ(100, frame->scan.distance[9]);
+	EXPECT_EQ(0, frame->scan.distance[10]);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 2, ScanFramePool_GetFreeCount());
+
+	ScanFramePool_Retain(frame);
+	ScanFramePool_Release(frame);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 2, ScanFramePool_GetFreeCount());
+	ScanFramePool_Release(frame);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 1, ScanFramePool_GetFreeCount());
+}
+
+//==============================================================================
+// Verify that releasing a frame that is already back in the pool has no
+// effect, so it cannot be handed out twice.
+//==============================================================================
+TEST_F(ScanFramePool, ReleasingFreeFrameIsIgnored)
+{
+	ScanFramePool_AddConsumer(RetainingConsumer);
+	AddRevolution(100);
+	AddRevolution(200);
+
+	ScanFramePool_Release(s_retained_frames[0]);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 1, ScanFramePool_GetFreeCount());
+	ScanFramePool_Release(s_retained_frames[0]);
+	EXPECT_EQ(ScanFramePool_NUM_FRAMES - 1, ScanFramePool_GetFreeCount());
+}
+
+//==============================================================================
+// Verify that running out of frames drops revolutions and counts them instead
+// of stalling, and that filling resumes once a frame is released.
+//==============================================================================
+TEST_F(ScanFramePool, ExhaustionIsCounted)
+{
+	ScanFramePool_AddConsumer(RetainingConsumer);
+	for (int i = 0; i < ScanFramePool_NUM_FRAMES + 2; ++i)
+		AddRevolution(100);
+
+	EXPECT_EQ(static_cast<size_t>(ScanFramePool_NUM_FRAMES), s_retained_frames.size());
+	EXPECT_EQ(2u, ScanFramePool_GetExhaustedCount());
+	EXPECT_EQ(0, ScanFramePool_GetSize());
+
+	ScanFramePool_Release(s_retained_frames[0]);
+	AddRevolution(100);
+	EXPECT_EQ(10, ScanFramePool_GetSize());
+}
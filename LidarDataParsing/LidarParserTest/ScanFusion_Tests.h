@@ -0,0 +1,98 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "ScanFusion.h"
+
+#include <cmath>
+
+class ScanFusion : public testing::Test
+{
+protected:
+	LidarScan_t scan_a;
+	LidarScan_t scan_b;
+
+	void SetUp()
+	{
+		for (int i = 0; i < LidarScan_NUM_ANGLES; ++i)
+		{
+			scan_a.distance[i] = 1000;
+			scan_b.distance[i] = (i % 2) ? 2000 : 0;
+		}
+	}
+
+	static float Bearing(const ScanFusionPoints_t * points, int i)
+	{
+		float bearing = std::atan2(points->y[i], points->x[i]);
+		return (bearing < 0) ? bearing + 2 * 3.14159265f : bearing;
+	}
+};
+
+//==============================================================================
+// Verify that the scans of all lidars in the window are merged in bearing
+// order, each transformed by its own mount.
+//==============================================================================
+TEST_F(ScanFusion, MergesScansInBearingOrder)
+{
+	ScanFusionMount_t mounts[2] = { { 100, 0, 0 }, { -100, 50, 90 } };
+	ScanFusion_Init(2, mounts);
+	ScanFusion_AddScan(0, 10, &scan_a);
+	ScanFusion_AddScan(1, 12, &scan_b);
+
+	const ScanFusionPoints_t * fused = ScanFusion_Fuse(10, 20);
+	ASSERT_EQ(360 + 180, fused->num_points);
+	for (int i = 1; i < fused->num_points; ++i)
+		EXPECT_LE(Bearing(fused, i - 1), Bearing(fused, i) + 1e-5f) << "at point " << i;
+}
+
+//==============================================================================
+// Verify that an offset lidar whose close and far returns alternate (so its
+// bearings double back at every slot) is still fused in bearing order.
+//==============================================================================
+TEST_F(ScanFusion, SortsInterleavedReturnsOfOffsetLidar)
+{
+	LidarScan_t scan;
+	for (int i = 0; i < LidarScan_NUM_ANGLES; ++i)
+		scan.distance[i] = (i % 2) ? 3000 : 150;
+	ScanFusionMount_t mount = { 500, -200, 30 };
+	ScanFusion_Init(1, &mount);
+	ScanFusion_AddScan(0, 0, &scan);
+
+	const ScanFusionPoints_t * fused = ScanFusion_Fuse(0, 1);
+	ASSERT_EQ(360, fused->num_points);
+	for (int i = 1; i < fused->num_points; ++i)
+		EXPECT_LE(Bearing(fused, i - 1), Bearing(fused, i) + 1e-5f) << "at point " << i;
+}
+
+//==============================================================================
+// Verify that a lidar's mount is applied to its points.
+//==============================================================================
+TEST_F(ScanFusion, AppliesMountTransform)
+{
+	LidarScan_t scan = {};
+	scan.distance[0] = 1000;
+	ScanFusionMount_t mount = { 100, 50, 90 };
+	ScanFusion_Init(1, &mount);
+	ScanFusion_AddScan(0, 0, &scan);
+
+	const ScanFusionPoints_t * fused = ScanFusion_Fuse(0, 1);
+	ASSERT_EQ(1, fused->num_points);
+	EXPECT_NEAR(100, fused->x[0], 1e-3);
+	EXPECT_NEAR(1050, fused->y[0], 1e-3);
+	EXPECT_EQ(0, fused->sensor[0]);
+}
+
+//==============================================================================
+// Verify that scans outside the time window are left out, including across
+// timestamp wrap-around.
+//==============================================================================
+TEST_F(ScanFusion, ExcludesScansOutsideWindow)
+{
+	ScanFusionMount_t mounts[2] = { { 0, 0, 0 }, { 0, 0, 0 } };
+	ScanFusion_Init(2, mounts);
+	ScanFusion_AddScan(0, 0xFFFFFFF0u, &scan_a);
+	ScanFusion_AddScan(1, 100, &scan_b);
+
+	EXPECT_EQ(360, ScanFusion_Fuse(0xFFFFFFE0u, 10)->num_points);
+	EXPECT_EQ(180, ScanFusion_Fuse(100, 200)->num_points);
+	EXPECT_EQ(0, ScanFusion_Fuse(200, 300)->num_points);
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "ScanLog.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+static std::vector<uint8_t> s_log_bytes;
+static std::vector<std::pair<uint32_t, LidarScan_t>> s_decoded_scans;
+
+void ScanLogTest_Write(const uint8_t * bytes, size_t count)
+{
+	s_log_bytes.insert(s_log_bytes.end(), bytes, bytes + count);
+}
+
+void ScanLogTest_AddScan(uint32_t timestamp, const LidarScan_t * scan)
+{
+	s_decoded_scans.emplace_back(timestamp, *scan);
+}
+
+class ScanLog : public testing::Test
+{
+protected:
+	ScanLogOutput_i output;
+	ScanLogWriter_t writer;
+	ScanLogReader_t reader;
+
+	void SetUp()
+	{
+		s_log_bytes.clear();
+		s_decoded_scans.clear();
+		output.Write = ScanLogTest_Write;
+		ScanLogWriter_Init(&writer, &output);
+	}
+
+	// a scan whose contents depend on the revolution number
+	static LidarScan_t MakeScan(uint32_t revolution)
+	{
+		LidarScan_t scan;
+		for (int i = 0; i < LidarScan_NUM_ANGLES; ++i)
+			scan.distance[i] = (i % 17 == 0) ? 0 : static_cast<uint16_t>(1000 + 10 * i + revolution);
+		return scan;
+	}
+
+	void ExpectScan(uint32_t revolution, uint32_t timestamp, const LidarScan_t & scan)
+	{
+		LidarScan_t expected = MakeScan(revolution);
+		EXPECT_EQ(revolution * 100, timestamp);
+		for (int i = 0; i < LidarScan_NUM_ANGLES; ++i)
+			ASSERT_EQ(expected.distance[i], scan.distance[i]) << "revolution " << revolution << ", angle " << i;
+	}
+};
+
+//==============================================================================
+// Verify that scans round-trip through the log in order, and that the log is
+// smaller than storing (index, distance) tuples.
+//==============================================================================
+TEST_F(ScanLog, RoundTripsSequentially)
+{
+	const uint32_t num_revolutions = 150;
+	for (uint32_t r = 0; r < num_revolutions; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	ScanLogWriter_Close(&writer);
+	EXPECT_LT(s_log_bytes.size(), num_revolutions * LidarScan_NUM_ANGLES * 4 / 3);
+
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_TRUE(ScanLogReader_HasIndex(&reader));
+	EXPECT_EQ(num_revolutions, ScanLogReader_GetRevolutionCount(&reader));
+
+	uint32_t timestamp;
+	LidarScan_t scan;
+	for (uint32_t r = 0; r < num_revolutions; ++r)
+	{
+		ASSERT_TRUE(ScanLogReader_Next(&reader, &timestamp, &scan));
+		ExpectScan(r, timestamp, scan);
+	}
+	EXPECT_FALSE(ScanLogReader_Next(&reader, &timestamp, &scan));
+}
+
+//==============================================================================
+// Verify that any revolution can be reached directly through the index.
+//==============================================================================
+TEST_F(ScanLog, SeeksToAnyRevolution)
+{
+	for (uint32_t r = 0; r < 200; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	ScanLogWriter_Close(&writer);
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+
+	uint32_t timestamp;
+	LidarScan_t scan;
+	for (uint32_t r : { 199u, 0u, 63u, 64u, 130u })
+	{
+		ASSERT_TRUE(ScanLogReader_Seek(&reader, r));
+		ASSERT_TRUE(ScanLogReader_Next(&reader, &timestamp, &scan));
+		ExpectScan(r, timestamp, scan);
+	}
+	EXPECT_FALSE(ScanLogReader_Seek(&reader, 200));
+}
+
+//==============================================================================
+// Verify that a log cut short without a trailer still reads sequentially up
+// to its last complete revolution.
+//==============================================================================
+TEST_F(ScanLog, TruncatedLogReadsSequentially)
+{
+	for (uint32_t r = 0; r < 3; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	s_log_bytes.resize(s_log_bytes.size() - 5);
+
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_FALSE(ScanLogReader_HasIndex(&reader));
+	EXPECT_EQ(2u, ScanLogReader_GetRevolutionCount(&reader));
+
+	uint32_t timestamp;
+	LidarScan_t scan;
+	ASSERT_TRUE(ScanLogReader_Next(&reader, &timestamp, &scan));
+	ExpectScan(0, timestamp, scan);
+	ASSERT_TRUE(ScanLogReader_Next(&reader, &timestamp, &scan));
+	ExpectScan(1, timestamp, scan);
+	EXPECT_FALSE(ScanLogReader_Next(&reader, &timestamp, &scan));
+}
+
+//==============================================================================
+// Verify that a log cut short after several index blocks is indexed when
+// opened, so revolutions before and after its last index block can be reached.
+//==============================================================================
+TEST_F(ScanLog, TruncatedLogRecoversIndex)
+{
+	for (uint32_t r = 0; r < 150; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	s_log_bytes.resize(s_log_bytes.size() - 5);
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_EQ(149u, ScanLogReader_GetRevolutionCount(&reader));
+
+	uint32_t timestamp;
+	LidarScan_t scan;
+	for (uint32_t r : { 148u, 0u, 70u, 128u, 127u })
+	{
+		ASSERT_TRUE(ScanLogReader_Seek(&reader, r));
+		ASSERT_TRUE(ScanLogReader_Next(&reader, &timestamp, &scan));
+		ExpectScan(r, timestamp, scan);
+	}
+	EXPECT_FALSE(ScanLogReader_Seek(&reader, 149));
+}
+
+//==============================================================================
+// Verify that an index block linking to itself makes seeking fail instead of
+// looping forever.
+//==============================================================================
+TEST_F(ScanLog, CyclicIndexChainIsRejected)
+{
+	for (uint32_t r = 0; r < 130; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	ScanLogWriter_Close(&writer);
+
+	// point the last index block (2 entries, so a one-byte length) at itself
+	size_t trailer = s_log_bytes.size() - 16;
+	size_t last_block = 0;
+	for (int i = 0; i < 8; ++i)
+		last_block |= static_cast<size_t>(s_log_bytes[trailer + i]) << (8 * i);
+	size_t link = last_block + 2;
+	for (int i = 0; i < 8; ++i)
+		s_log_bytes[link + i] = static_cast<uint8_t>(last_block >> (8 * i));
+
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_TRUE(ScanLogReader_Seek(&reader, 129));
+	EXPECT_FALSE(ScanLogReader_Seek(&reader, 0));
+}
+
+//==============================================================================
+// Verify that the streaming decoder yields every revolution of a closed log fed
+// in small chunks, with records split across chunks.
+//==============================================================================
+TEST_F(ScanLog, DecoderReadsLogInChunks)
+{
+	const uint32_t num_revolutions = 70;
+	for (uint32_t r = 0; r < num_revolutions; ++r)
+	{
+		LidarScan_t scan = MakeScan(r);
+		ScanLogWriter_AddScan(&writer, r * 100, &scan);
+	}
+	ScanLogWriter_Close(&writer);
+
+	ScanLogDecoderOutput_i decoder_output;
+	decoder_output.AddScan = ScanLogTest_AddScan;
+	ScanLogDecoder_t decoder;
+	ScanLogDecoder_Init(&decoder, &decoder_output);
+	for (size_t offset = 0; offset < s_log_bytes.size(); offset += 7)
+	{
+		size_t count = std::min<size_t>(7, s_log_bytes.size() - offset);
+		ASSERT_TRUE(ScanLogDecoder_Feed(&decoder, s_log_bytes.data() + offset, count));
+	}
+
+	ASSERT_EQ(num_revolutions, s_decoded_scans.size());
+	for (uint32_t r = 0; r < num_revolutions; ++r)
+		ExpectScan(r, s_decoded_scans[r].first, s_decoded_scans[r].second);
+}
+
+//==============================================================================
+// Verify that the streaming decoder rejects data that is not a scan log.
+//==============================================================================
+TEST_F(ScanLog, DecoderRejectsInvalidHeader)
+{
+	ScanLogDecoderOutput_i decoder_output;
+	decoder_output.AddScan = ScanLogTest_AddScan;
+	ScanLogDecoder_t decoder;
+	ScanLogDecoder_Init(&decoder, &decoder_output);
+
+	const uint8_t bytes[] = { 'X', 'V', 'S', 'Q', 1, 0, 0, 0 };
+	EXPECT_FALSE(ScanLogDecoder_Feed(&decoder, bytes, sizeof(bytes)));
+	EXPECT_FALSE(ScanLogDecoder_Feed(&decoder, bytes, sizeof(bytes)));
+}
+
+//==============================================================================
+// Verify that a revolution whose deltas sum to a distance outside 0..65535 is
+// rejected as malformed by both the reader and the streaming decoder.
+//==============================================================================
+TEST_F(ScanLog, OutOfRangeDistanceIsMalformed)
+{
+	LidarScan_t scan = MakeScan(0);
+	ScanLogWriter_AddScan(&writer, 0, &scan);
+	ScanLogWriter_Close(&writer);
+
+	// the first delta of the revolution (header, type, 2-byte length and
+	// timestamp precede it) becomes -1
+	ASSERT_EQ(0, s_log_bytes[8 + 1 + 2 + 4]);
+	s_log_bytes[8 + 1 + 2 + 4] = 1;
+
+	uint32_t timestamp;
+	ASSERT_TRUE(ScanLogReader_Open(&reader, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_FALSE(ScanLogReader_Next(&reader, &timestamp, &scan));
+
+	ScanLogDecoderOutput_i decoder_output;
+	decoder_output.AddScan = ScanLogTest_AddScan;
+	ScanLogDecoder_t decoder;
+	ScanLogDecoder_Init(&decoder, &decoder_output);
+	EXPECT_FALSE(ScanLogDecoder_Feed(&decoder, s_log_bytes.data(), s_log_bytes.size()));
+	EXPECT_TRUE(s_decoded_scans.empty());
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "TemporalFilter.h"
+
+class TemporalFilter : public testing::Test
+{
+protected:
+	// feeds one full revolution where every angle reads the given distance
+	void AddRevolution(uint16_t distance)
+	{
+		for (uint16_t i = 0; i < LidarScan_NUM_ANGLES; ++i)
+			TemporalFilter_AddMeasurement(i, distance);
+	}
+
+	// starts the next revolution, which completes the current one
+	void CloseRevolution()
+	{
+		TemporalFilter_AddMeasurement(0, 0);
+	}
+};
+
+//==============================================================================
+// Verify that a revolution is completed when the angle index wraps around.
+//==============================================================================
+TEST_F(TemporalFilter, RevolutionCompletesOnIndexWrap)
+{
+	TemporalFilter_Init(4, TemporalFilter_MEAN);
+	AddRevolution(100);
+	EXPECT_EQ(0u, TemporalFilter_GetRevolutionCount());
+	EXPECT_EQ(LidarScan_NUM_ANGLES, TemporalFilter_GetSize());
+	CloseRevolution();
+	EXPECT_EQ(1u, TemporalFilter_GetRevolutionCount());
+	EXPECT_EQ(1, TemporalFilter_GetSize());
+	EXPECT_EQ(100, TemporalFilter_GetScan()->distance[0]);
+}
+
+//==============================================================================
+// Verify that the mean only spans the configured number of revolutions and
+// ignores readings with no return.
+//==============================================================================
+TEST_F(TemporalFilter, Mean_SpansLastRevolutionsOnly)
+{
+	TemporalFilter_Init(2, TemporalFilter_MEAN);
+	AddRevolution(100);
+	AddRevolution(200);
+	AddRevolution(400);
+	CloseRevolution();
+	EXPECT_EQ(300, TemporalFilter_GetScan()->distance[1]);
+
+	TemporalFilter_AddMeasurement(5, 0);
+	TemporalFilter_AddMeasurement(6, 600);
+	CloseRevolution();
+
+	const LidarScan_t * scan = TemporalFilter_GetScan();
+	EXPECT_EQ(4u, TemporalFilter_GetRevolutionCount());
+	EXPECT_EQ(400, scan->distance[5]);
+	EXPECT_EQ(500, scan->distance[6]);
+	EXPECT_EQ(400, scan->distance[7]);
+}
+
+//==============================================================================
+// Verify that the median rejects a single spike and ignores missing readings.
+//==============================================================================
+TEST_F(TemporalFilter, Median_RejectsSpike)
+{
+	TemporalFilter_Init(3, TemporalFilter_MEDIAN);
+	AddRevolution(100);
+	AddRevolution(5000);
+	AddRevolution(110);
+	CloseRevolution();
+	EXPECT_EQ(110, TemporalFilter_GetScan()->distance[42]);
+
+	// replace the oldest revolution with one that has no returns
+	AddRevolution(0);
+	CloseRevolution();
+	EXPECT_EQ(110, TemporalFilter_GetScan()->distance[42]);
+}
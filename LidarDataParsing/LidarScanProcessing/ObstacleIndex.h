@@ -0,0 +1,42 @@
+#ifndef OBSTACLE_INDEX_H
+#define OBSTACLE_INDEX_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "LidarScan.h"
+
+///=============================================================================
+/// Clears the index; every angle reports no return.
+///=============================================================================
+void ObstacleIndex_Init ();
+
+///=============================================================================
+/// Records the latest distance at an angle in O(log n) (see
+/// LidarMeasurementBuffer_i). A distance of 0 (no return) removes the angle
+/// from the index.
+///
+/// Preconditions:
+///  - Module has been initialized.
+///=============================================================================
+void ObstacleIndex_AddMeasurement (uint16_t index, uint16_t distance);
+
+///=============================================================================
+/// Returns the number of measurements recorded since initialization.
+///=============================================================================
+int ObstacleIndex_GetSize ();
+
+///=============================================================================
+/// Returns the smallest non-zero distance among angles first_angle..last_angle
+/// (inclusive, wrapping past 359 when first_angle > last_angle) in O(log n),
+/// and stores its angle in *angle. Ties go to the lowest angle number. Returns
+/// 0 and stores -1 if no angle in the range has a return, or unless
+/// 0 <= first_angle, last_angle < 360.
+///=============================================================================
+uint16_t ObstacleIndex_FindNearest (int first_angle, int last_angle, int * angle);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // OBSTACLE_INDEX_H
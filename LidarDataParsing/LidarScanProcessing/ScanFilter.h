@@ -0,0 +1,49 @@
+#ifndef SCAN_FILTER_H
+#define SCAN_FILTER_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "LidarScan.h"
+
+///=============================================================================
+/// Angular filters over a completed scan. With GCC or Clang, ScanFilter.c is
+/// compiled with -O2 -ftree-vectorize whatever the build type, so that the
+/// median and outlier filters are vectorized; other compilers need their own
+/// auto-vectorization enabled.
+///=============================================================================
+
+///=============================================================================
+/// Applies a 3-point angular median filter to a completed scan. Neighbors wrap
+/// around at 0/359 degrees. Single zero readings between two returns are
+/// filled in, and single spikes are flattened.
+///
+/// Preconditions:
+///  - in and out do not overlap.
+///=============================================================================
+void ScanFilter_Median (const LidarScan_t * in, LidarScan_t * out);
+
+///=============================================================================
+/// Removes isolated points: a distance is set to 0 when it differs from both
+/// of its angular neighbors by more than max_jump.
+///
+/// Preconditions:
+///  - in and out do not overlap.
+///=============================================================================
+void ScanFilter_RejectOutliers (const LidarScan_t * in, LidarScan_t * out, uint16_t max_jump);
+
+///=============================================================================
+/// Downsamples a scan into LidarScan_NUM_ANGLES / factor angular bins, keeping
+/// the nearest non-zero return of each bin (0 if the bin has no return). Bin k
+/// covers angles [k * factor, (k + 1) * factor).
+///
+/// Returns the number of bins written to out, or 0 if factor does not evenly
+/// divide LidarScan_NUM_ANGLES.
+///=============================================================================
+int ScanFilter_Downsample (const LidarScan_t * in, int factor, uint16_t * out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SCAN_FILTER_H
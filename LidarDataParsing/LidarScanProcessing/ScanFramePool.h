@@ -0,0 +1,85 @@
+#ifndef SCAN_FRAME_POOL_H
+#define SCAN_FRAME_POOL_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "LidarScan.h"
+
+/// Number of scan frames in the pool.
+#define ScanFramePool_NUM_FRAMES 4
+
+/// Maximum number of consumers that receive completed frames.
+#define ScanFramePool_MAX_CONSUMERS 4
+
+typedef struct {
+
+	/// Number of the revolution, counting from 0 after initialization.
+	uint32_t sequence;
+
+	/// Number of measurements received during the revolution.
+	int num_measurements;
+
+	LidarScan_t scan;
+
+} ScanFrame_t;
+
+/// Called with each completed frame. The consumer must call
+/// ScanFramePool_Retain if it keeps the frame after returning.
+typedef void (*ScanFrameConsumer_t) (const ScanFrame_t * frame);
+
+///=============================================================================
+/// Returns all frames to the pool and removes all consumers.
+///=============================================================================
+void ScanFramePool_Init ();
+
+///=============================================================================
+/// Registers a consumer of completed frames. Returns false if
+/// ScanFramePool_MAX_CONSUMERS are already registered.
+///=============================================================================
+bool ScanFramePool_AddConsumer (ScanFrameConsumer_t consumer);
+
+///=============================================================================
+/// Records a measurement into the frame of the current revolution (see
+/// LidarMeasurementBuffer_i). When a new revolution starts, the current frame
+/// is handed to every consumer and a new frame is taken from the pool; if none
+/// is free, the revolution is dropped and counted as an exhaustion.
+///
+/// Preconditions:
+///  - Module has been initialized.
+///=============================================================================
+void ScanFramePool_AddMeasurement (uint16_t index, uint16_t distance);
+
+///=============================================================================
+/// Returns the number of measurements recorded in the current revolution.
+///=============================================================================
+int ScanFramePool_GetSize ();
+
+///=============================================================================
+/// Adds a reference to a frame handed to a consumer.
+///=============================================================================
+void ScanFramePool_Retain (const ScanFrame_t * frame);
+
+///=============================================================================
+/// Drops a reference to a frame; the frame returns to the pool when its last
+/// reference is dropped. Releasing a frame that is already back in the pool
+/// has no effect.
+///=============================================================================
+void ScanFramePool_Release (const ScanFrame_t * frame);
+
+///=============================================================================
+/// Returns the number of frames currently in the pool.
+///=============================================================================
+int ScanFramePool_GetFreeCount ();
+
+///=============================================================================
+/// Returns the number of revolutions dropped because no frame was free.
+///=============================================================================
+uint32_t ScanFramePool_GetExhaustedCount ();
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SCAN_FRAME_POOL_H
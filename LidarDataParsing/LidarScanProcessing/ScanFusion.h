@@ -0,0 +1,63 @@
+#ifndef SCAN_FUSION_H
+#define SCAN_FUSION_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "LidarScan.h"
+
+/// Maximum number of lidars that can be fused.
+#define ScanFusion_MAX_SENSORS 4
+
+/// Maximum number of points in a fused point set.
+#define ScanFusion_MAX_POINTS (ScanFusion_MAX_SENSORS * LidarScan_NUM_ANGLES)
+
+/// Pose of a lidar in the robot frame. Angles are counterclockwise, in
+/// degrees, and a lidar's angle 0 points along its mounting yaw.
+typedef struct {
+	float x;
+	float y;
+	float yaw_degrees;
+} ScanFusionMount_t;
+
+/// Fused points in the robot frame (same unit as the lidar distances),
+/// ordered by bearing counterclockwise from the robot's x axis.
+typedef struct {
+	int num_points;
+	float x[ScanFusion_MAX_POINTS];
+	float y[ScanFusion_MAX_POINTS];
+	uint8_t sensor[ScanFusion_MAX_POINTS];
+} ScanFusionPoints_t;
+
+///=============================================================================
+/// Initializes the fusion stage for `num_sensors` lidars with the given
+/// mounting poses.
+///
+/// Preconditions:
+///  - 1 <= num_sensors <= ScanFusion_MAX_SENSORS
+///=============================================================================
+void ScanFusion_Init (int num_sensors, const ScanFusionMount_t * mounts);
+
+///=============================================================================
+/// Records the latest scan of a lidar, taken at `timestamp` (any unit, may
+/// wrap around). The scan is transformed into the robot frame immediately;
+/// the caller's scan is not referenced afterwards.
+///
+/// Preconditions:
+///  - Module has been initialized.
+///  - 0 <= sensor < num_sensors
+///=============================================================================
+void ScanFusion_AddScan (int sensor, uint32_t timestamp, const LidarScan_t * scan);
+
+///=============================================================================
+/// Merges the latest scans of all lidars whose timestamp lies in
+/// [window_start, window_end) into one point set. The result is owned by the
+/// module and is overwritten by the next call.
+///=============================================================================
+const ScanFusionPoints_t * ScanFusion_Fuse (uint32_t window_start, uint32_t window_end);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SCAN_FUSION_H
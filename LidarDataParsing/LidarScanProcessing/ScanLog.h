@@ -0,0 +1,157 @@
+#ifndef SCAN_LOG_H
+#define SCAN_LOG_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "LidarScan.h"
+
+///=============================================================================
+/// Compact log of scans.
+///
+/// File layout (all fixed-width integers little-endian):
+///   header:      "XVSL", version (1 byte), 3 reserved bytes
+///   records:     type (1 byte), payload length (varint), payload
+///     revolution:  timestamp (uint32), then for each angle the zigzag varint
+///                  of the difference to the previous angle's distance
+///     index block: offset of the previous index block (uint64, all ones if
+///                  none), first revolution number (uint32), number of
+///                  entries (uint16), file offset of each revolution (uint64)
+///     trailer:     offset of the last index block (uint64), number of
+///                  revolutions (uint32), "XVSX"; always the last record
+///
+/// The writer emits an index block every ScanLog_INDEX_BLOCK_SIZE revolutions,
+/// so its memory use does not grow with the log. A log without trailer (for
+/// example, cut short by a power loss) is indexed by scanning its records when
+/// opened. Since the trailer is a record like any other, a log can also be
+/// decoded front to back in chunks of any size with ScanLogDecoder.
+///=============================================================================
+
+/// Number of revolutions covered by one index block.
+#define ScanLog_INDEX_BLOCK_SIZE 64
+
+/// Largest possible encoded revolution record.
+#define ScanLog_MAX_RECORD_SIZE (1 + 5 + 4 + 3 * LidarScan_NUM_ANGLES)
+
+typedef struct {
+
+	/// Method to append bytes to the log.
+	void (*Write) (const uint8_t * bytes, size_t count);
+
+} ScanLogOutput_i;
+
+typedef struct {
+
+	/// Method called with each revolution decoded by a ScanLogDecoder.
+	void (*AddScan) (uint32_t timestamp, const LidarScan_t * scan);
+
+} ScanLogDecoderOutput_i;
+
+/// State of a log writer; the fields are private to the module.
+typedef struct {
+	ScanLogOutput_i * output;
+	uint64_t offset;
+	uint32_t num_revolutions;
+	uint64_t last_index_block;
+	uint64_t block_offsets[ScanLog_INDEX_BLOCK_SIZE];
+	int block_size;
+	uint8_t record[ScanLog_MAX_RECORD_SIZE];
+} ScanLogWriter_t;
+
+/// State of a log reader; the fields are private to the module.
+typedef struct {
+	const uint8_t * data;
+	size_t size;
+	size_t position;
+	bool has_trailer;
+	uint64_t last_index_block;
+	uint32_t num_revolutions;
+	size_t unindexed_offset;
+	uint32_t first_unindexed;
+} ScanLogReader_t;
+
+/// State of a streaming decoder; the fields are private to the module.
+typedef struct {
+	ScanLogDecoderOutput_i * output;
+	int stage;
+	int header_size;
+	uint8_t type;
+	uint32_t length;
+	int length_shift;
+	uint32_t payload_size;
+	bool failed;
+	uint8_t record[ScanLog_MAX_RECORD_SIZE];
+	LidarScan_t scan;
+} ScanLogDecoder_t;
+
+///=============================================================================
+/// Initializes the writer and writes the log header.
+///=============================================================================
+void ScanLogWriter_Init (ScanLogWriter_t * writer, ScanLogOutput_i * output);
+
+///=============================================================================
+/// Appends one revolution to the log.
+///=============================================================================
+void ScanLogWriter_AddScan (ScanLogWriter_t * writer, uint32_t timestamp, const LidarScan_t * scan);
+
+///=============================================================================
+/// Writes the last index block and the trailer. No scans may be added after.
+///=============================================================================
+void ScanLogWriter_Close (ScanLogWriter_t * writer);
+
+///=============================================================================
+/// Opens a log held in memory (for example a mapped file). Returns false if
+/// the header is invalid. A log without trailer is scanned up to its last
+/// complete record to find its index blocks and count its revolutions.
+///
+/// Preconditions:
+///  - The data outlives the reader.
+///=============================================================================
+bool ScanLogReader_Open (ScanLogReader_t * reader, const uint8_t * data, size_t size);
+
+///=============================================================================
+/// Returns true if the log ends with a trailer, i.e. was closed by the writer.
+///=============================================================================
+bool ScanLogReader_HasIndex (ScanLogReader_t * reader);
+
+///=============================================================================
+/// Returns the number of revolutions in the log.
+///=============================================================================
+uint32_t ScanLogReader_GetRevolutionCount (ScanLogReader_t * reader);
+
+///=============================================================================
+/// Positions the reader so that the next call to ScanLogReader_Next returns
+/// the given revolution (numbered from 0). Revolutions covered by an index
+/// block are found through the index; the ones written after the last index
+/// block of a log cut short are found by skipping records. Returns false if
+/// the revolution does not exist or the index is corrupt.
+///=============================================================================
+bool ScanLogReader_Seek (ScanLogReader_t * reader, uint32_t revolution);
+
+///=============================================================================
+/// Decodes the next revolution. Returns false at the end of the log or if
+/// the next record is malformed.
+///=============================================================================
+bool ScanLogReader_Next (ScanLogReader_t * reader, uint32_t * timestamp, LidarScan_t * scan);
+
+///=============================================================================
+/// Initializes a decoder that reads a log from its beginning, in chunks
+/// passed to ScanLogDecoder_Feed, and hands every revolution to the output.
+///=============================================================================
+void ScanLogDecoder_Init (ScanLogDecoder_t * decoder, ScanLogDecoderOutput_i * output);
+
+///=============================================================================
+/// Decodes the next chunk of the log. A record split across chunks is
+/// buffered until it is complete, so memory use is bounded by
+/// ScanLog_MAX_RECORD_SIZE. Returns false, now and for every later chunk, once
+/// the header is invalid or a record is malformed.
+///=============================================================================
+bool ScanLogDecoder_Feed (ScanLogDecoder_t * decoder, const uint8_t * bytes, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SCAN_LOG_H
@@ -0,0 +1,57 @@
+#ifndef TEMPORAL_FILTER_H
+#define TEMPORAL_FILTER_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "LidarScan.h"
+
+/// Maximum number of revolutions the filter can be configured to span.
+#define TemporalFilter_MAX_DEPTH 8
+
+typedef enum
+{
+	TemporalFilter_MEAN,
+	TemporalFilter_MEDIAN
+}
+TemporalFilterMode_t;
+
+///=============================================================================
+/// Initializes the filter to combine each angle slot over the last `depth`
+/// revolutions. Readings of 0 (no return) are excluded from the mean/median.
+///
+/// Preconditions:
+///  - 1 <= depth <= TemporalFilter_MAX_DEPTH
+///=============================================================================
+void TemporalFilter_Init (int depth, TemporalFilterMode_t mode);
+
+///=============================================================================
+/// Records a measurement (see LidarMeasurementBuffer_i). When a new
+/// revolution starts, the filtered scan is recomputed.
+///
+/// Preconditions:
+///  - Module has been initialized.
+///=============================================================================
+void TemporalFilter_AddMeasurement (uint16_t index, uint16_t distance);
+
+///=============================================================================
+/// Returns the number of measurements recorded in the current revolution.
+///=============================================================================
+int TemporalFilter_GetSize ();
+
+///=============================================================================
+/// Returns the number of revolutions completed since initialization.
+///=============================================================================
+uint32_t TemporalFilter_GetRevolutionCount ();
+
+///=============================================================================
+/// Returns the filtered scan as of the last completed revolution. The scan is
+/// owned by the module and is overwritten when the next revolution completes.
+///=============================================================================
+const LidarScan_t * TemporalFilter_GetScan ();
+
+#ifdef __cplusplus
+}
+#endif
+#endif // TEMPORAL_FILTER_H
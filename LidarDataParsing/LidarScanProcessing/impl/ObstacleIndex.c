@@ -0,0 +1,105 @@
+#include "ObstacleIndex.h"
+
+#include <stdbool.h>
+
+//==============================================================================
+// index state
+//
+// A bottom-up segment tree over the angle slots. Each node holds the minimum
+// of its children, with the distance in the upper 16 bits and the angle in the
+// lower 16 bits, so that a single unsigned comparison finds the nearest
+// return and its angle. Angles without a return hold NO_RETURN. A bottom-up
+// tree needs no power-of-two size for a minimum query, so there is exactly one
+// leaf per angle.
+//==============================================================================
+
+#define NUM_LEAVES LidarScan_NUM_ANGLES
+#define NO_RETURN 0xFFFFFFFFu
+
+static struct
+{
+	uint32_t tree[2 * NUM_LEAVES];
+	int size;
+}
+obstacles;
+
+//==============================================================================
+// helper methods
+//==============================================================================
+
+static uint32_t min32(uint32_t a, uint32_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static bool isAngle(int angle)
+{
+	return angle >= 0 && angle < LidarScan_NUM_ANGLES;
+}
+
+//==============================================================================
+// Minimum over the leaves first..last (inclusive, no wrap-around).
+//==============================================================================
+static uint32_t queryRange(int first, int last)
+{
+	uint32_t nearest = NO_RETURN;
+	int left = first + NUM_LEAVES;
+	int right = last + NUM_LEAVES + 1;
+	while (left < right)
+	{
+		if (left & 1)
+			nearest = min32(nearest, obstacles.tree[left++]);
+		if (right & 1)
+			nearest = min32(nearest, obstacles.tree[--right]);
+		left >>= 1;
+		right >>= 1;
+	}
+	return nearest;
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void ObstacleIndex_Init()
+{
+	for (int i = 0; i < 2 * NUM_LEAVES; ++i)
+		obstacles.tree[i] = NO_RETURN;
+	obstacles.size = 0;
+}
+
+void ObstacleIndex_AddMeasurement(uint16_t index, uint16_t distance)
+{
+	if (index >= LidarScan_NUM_ANGLES)
+		return;
+	++obstacles.size;
+
+	int node = index + NUM_LEAVES;
+	obstacles.tree[node] = distance ? ((uint32_t)distance << 16) | index : NO_RETURN;
+	for (node >>= 1; node > 0; node >>= 1)
+		obstacles.tree[node] = min32(obstacles.tree[2 * node], obstacles.tree[2 * node + 1]);
+}
+
+int ObstacleIndex_GetSize()
+{
+	return obstacles.size;
+}
+
+uint16_t ObstacleIndex_FindNearest(int first_angle, int last_angle, int * angle)
+{
+	uint32_t nearest;
+	if (!isAngle(first_angle) || !isAngle(last_angle))
+		nearest = NO_RETURN;
+	else if (first_angle <= last_angle)
+		nearest = queryRange(first_angle, last_angle);
+	else
+		nearest = min32(queryRange(first_angle, LidarScan_NUM_ANGLES - 1), queryRange(0, last_angle));
+
+	if (nearest == NO_RETURN)
+	{
+		*angle = -1;
+		return 0;
+	}
+	*angle = (int)(nearest & 0xFFFF);
+	return (uint16_t)(nearest >> 16);
+}
@@ -0,0 +1,92 @@
+#include "ScanFilter.h"
+
+#include <stdbool.h>
+
+//==============================================================================
+// helper methods
+//
+// The filters below are written as branch-free loops over contiguous arrays so
+// the compiler can vectorize them; the wrap-around slots at 0 and 359 degrees
+// are handled separately to keep the main loops free of modulo arithmetic.
+//==============================================================================
+
+static inline uint16_t min16(uint16_t a, uint16_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static inline uint16_t max16(uint16_t a, uint16_t b)
+{
+	return (a > b) ? a : b;
+}
+
+static inline uint16_t absdiff16(uint16_t a, uint16_t b)
+{
+	return (a > b) ? a - b : b - a;
+}
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+{
+	return max16(min16(a, b), min16(max16(a, b), c));
+}
+
+static inline uint16_t rejectIsolated(uint16_t left, uint16_t center, uint16_t right, uint16_t max_jump)
+{
+	bool isolated = (absdiff16(center, left) > max_jump) & (absdiff16(center, right) > max_jump);
+	return isolated ? 0 : center;
+}
+
+#define LAST_ANGLE (LidarScan_NUM_ANGLES - 1)
+
+// The arrays are restrict-qualified parameters, rather than locals, because
+// GCC only trusts restrict on parameters: with locals it still versions the
+// loops with a runtime overlap check.
+static void medianRun(const uint16_t * restrict src, uint16_t * restrict dst)
+{
+	dst[0] = median3(src[LAST_ANGLE], src[0], src[1]);
+	for (int i = 1; i < LAST_ANGLE; ++i)
+		dst[i] = median3(src[i - 1], src[i], src[i + 1]);
+	dst[LAST_ANGLE] = median3(src[LAST_ANGLE - 1], src[LAST_ANGLE], src[0]);
+}
+
+static void rejectOutliersRun(const uint16_t * restrict src, uint16_t * restrict dst, uint16_t max_jump)
+{
+	dst[0] = rejectIsolated(src[LAST_ANGLE], src[0], src[1], max_jump);
+	for (int i = 1; i < LAST_ANGLE; ++i)
+		dst[i] = rejectIsolated(src[i - 1], src[i], src[i + 1], max_jump);
+	dst[LAST_ANGLE] = rejectIsolated(src[LAST_ANGLE - 1], src[LAST_ANGLE], src[0], max_jump);
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void ScanFilter_Median(const LidarScan_t * in, LidarScan_t * out)
+{
+	medianRun(in->distance, out->distance);
+}
+
+void ScanFilter_RejectOutliers(const LidarScan_t * in, LidarScan_t * out, uint16_t max_jump)
+{
+	rejectOutliersRun(in->distance, out->distance, max_jump);
+}
+
+int ScanFilter_Downsample(const LidarScan_t * in, int factor, uint16_t * out)
+{
+	if (factor <= 0 || LidarScan_NUM_ANGLES % factor != 0)
+		return 0;
+
+	int num_bins = LidarScan_NUM_ANGLES / factor;
+	const uint16_t * src = in->distance;
+	for (int bin = 0; bin < num_bins; ++bin)
+	{
+		// subtracting 1 maps "no return" (0) to 0xFFFF so that it never wins
+		// the minimum; adding 1 afterwards maps an empty bin back to 0
+		uint16_t nearest = 0xFFFF;
+		for (int j = 0; j < factor; ++j)
+			nearest = min16(nearest, (uint16_t)(src[j] - 1));
+		out[bin] = (uint16_t)(nearest + 1);
+		src += factor;
+	}
+	return num_bins;
+}
@@ -0,0 +1,142 @@
+#include "ScanFramePool.h"
+
+#include <stddef.h>
+
+//==============================================================================
+// pool state
+//
+// Free frames are kept on a stack of frame numbers, so taking and returning a
+// frame is O(1). Reference counts are not atomic; like the rest of the parser
+// the pool is meant to be used from a single thread.
+//==============================================================================
+
+static struct
+{
+	ScanFrame_t frames[ScanFramePool_NUM_FRAMES];
+	int ref_counts[ScanFramePool_NUM_FRAMES];
+
+	int free_frames[ScanFramePool_NUM_FRAMES];
+	int num_free;
+
+	ScanFrameConsumer_t consumers[ScanFramePool_MAX_CONSUMERS];
+	int num_consumers;
+
+	// frame being filled, or NULL if the pool was exhausted
+	ScanFrame_t * current;
+	LidarRevolution_t revolution;
+	uint32_t sequence;
+	uint32_t exhausted;
+}
+pool;
+
+//==============================================================================
+// helper methods
+//==============================================================================
+
+static ScanFrame_t * acquireFrame()
+{
+	if (pool.num_free == 0)
+	{
+		++pool.exhausted;
+		return NULL;
+	}
+
+	int number = pool.free_frames[--pool.num_free];
+	pool.ref_counts[number] = 1;
+
+	ScanFrame_t * frame = &pool.frames[number];
+	frame->sequence = pool.sequence;
+	frame->num_measurements = 0;
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+		frame->scan.distance[a] = 0;
+	return frame;
+}
+
+static void completeRevolution()
+{
+	if (pool.current)
+	{
+		for (int i = 0; i < pool.num_consumers; ++i)
+			pool.consumers[i](pool.current);
+
+		// drop the pool's own reference
+		ScanFramePool_Release(pool.current);
+	}
+
+	++pool.sequence;
+	pool.current = acquireFrame();
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void ScanFramePool_Init()
+{
+	for (int i = 0; i < ScanFramePool_NUM_FRAMES; ++i)
+	{
+		pool.ref_counts[i] = 0;
+		pool.free_frames[i] = i;
+	}
+	pool.num_free = ScanFramePool_NUM_FRAMES;
+	pool.num_consumers = 0;
+	LidarRevolution_Reset(&pool.revolution);
+	pool.sequence = 0;
+	pool.exhausted = 0;
+	pool.current = acquireFrame();
+}
+
+bool ScanFramePool_AddConsumer(ScanFrameConsumer_t consumer)
+{
+	if (pool.num_consumers == ScanFramePool_MAX_CONSUMERS)
+		return false;
+	pool.consumers[pool.num_consumers++] = consumer;
+	return true;
+}
+
+void ScanFramePool_AddMeasurement(uint16_t index, uint16_t distance)
+{
+	if (index >= LidarScan_NUM_ANGLES)
+		return;
+
+	if (LidarRevolution_Next(&pool.revolution, index))
+		completeRevolution();
+
+	if (pool.current)
+	{
+		pool.current->scan.distance[index] = distance;
+		++pool.current->num_measurements;
+	}
+}
+
+int ScanFramePool_GetSize()
+{
+	return pool.current ? pool.current->num_measurements : 0;
+}
+
+void ScanFramePool_Retain(const ScanFrame_t * frame)
+{
+	++pool.ref_counts[frame - pool.frames];
+}
+
+void ScanFramePool_Release(const ScanFrame_t * frame)
+{
+	int number = (int)(frame - pool.frames);
+
+	// a frame without references is already on the free stack
+	if (pool.ref_counts[number] == 0)
+		return;
+
+	if (--pool.ref_counts[number] == 0)
+		pool.free_frames[pool.num_free++] = number;
+}
+
+int ScanFramePool_GetFreeCount()
+{
+	return pool.num_free;
+}
+
+uint32_t ScanFramePool_GetExhaustedCount()
+{
+	return pool.exhausted;
+}
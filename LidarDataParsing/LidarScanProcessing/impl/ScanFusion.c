@@ -0,0 +1,269 @@
+#include "ScanFusion.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+//==============================================================================
+// fusion state
+//
+// Every lidar's latest scan is kept as a run of robot-frame points sorted by
+// bearing, so fusing is a k-way merge of the runs rather than a sort. The
+// bearing is represented by a pseudo-angle, which orders points the same way
+// as atan2 but needs no trigonometry.
+//==============================================================================
+
+typedef struct
+{
+	bool has_scan;
+	uint32_t timestamp;
+	int num_points;
+	float x[LidarScan_NUM_ANGLES];
+	float y[LidarScan_NUM_ANGLES];
+	float bearing[LidarScan_NUM_ANGLES];
+}
+Run_t;
+
+static struct
+{
+	int num_sensors;
+	ScanFusionMount_t mounts[ScanFusion_MAX_SENSORS];
+
+	// direction of each angle slot in the robot frame, per lidar
+	float cos_table[ScanFusion_MAX_SENSORS][LidarScan_NUM_ANGLES];
+	float sin_table[ScanFusion_MAX_SENSORS][LidarScan_NUM_ANGLES];
+
+	Run_t runs[ScanFusion_MAX_SENSORS];
+
+	// transformed points in the lidar's own angle order, before rotation, and
+	// the second buffer of the merge sort afterwards
+	Run_t scratch;
+	int run_starts[LidarScan_NUM_ANGLES + 1];
+
+	ScanFusionPoints_t fused;
+}
+fusion;
+
+//==============================================================================
+// helper methods
+//==============================================================================
+
+#define DEGREES_TO_RADIANS 0.017453292519943295
+
+//==============================================================================
+// Maps a direction to [0, 4), increasing monotonically with its angle
+// counterclockwise from the x axis ("diamond angle").
+//==============================================================================
+static float pseudoAngle(float x, float y)
+{
+	if (y >= 0)
+		return (x >= 0) ? ((x + y > 0) ? y / (x + y) : 0) : 1 - x / (-x + y);
+	return (x < 0) ? 2 - y / (-x - y) : 3 + x / (x - y);
+}
+
+static void copyPoint(Run_t * to, int i, const Run_t * from, int j)
+{
+	to->x[i] = from->x[j];
+	to->y[i] = from->y[j];
+	to->bearing[i] = from->bearing[j];
+}
+
+static void reversePoints(Run_t * run, int first, int last)
+{
+	for (; first < last; ++first, --last)
+	{
+		float x = run->x[first];
+		float y = run->y[first];
+		float bearing = run->bearing[first];
+		copyPoint(run, first, run, last);
+		run->x[last] = x;
+		run->y[last] = y;
+		run->bearing[last] = bearing;
+	}
+}
+
+//==============================================================================
+// Splits the points into runs of non-decreasing bearing, reversing strictly
+// decreasing stretches in place, and records where each run starts. Returns
+// the number of runs; run_starts[count] is the number of points.
+//==============================================================================
+static int splitIntoSortedRuns(Run_t * run, int * run_starts)
+{
+	int count = 0;
+	int i = 0;
+	while (i < run->num_points)
+	{
+		int first = i++;
+		if (i < run->num_points && run->bearing[i] < run->bearing[first])
+		{
+			while (i < run->num_points && run->bearing[i] < run->bearing[i - 1])
+				++i;
+			reversePoints(run, first, i - 1);
+		}
+		else
+		{
+			while (i < run->num_points && run->bearing[i] >= run->bearing[i - 1])
+				++i;
+		}
+		run_starts[count++] = first;
+	}
+	run_starts[count] = run->num_points;
+	return count;
+}
+
+//==============================================================================
+// Sorts the points by bearing with a natural merge sort, using scratch as the
+// second buffer. A centred lidar's rotated points are already one sorted run;
+// an offset lidar's are a few monotonic runs (the bearing doubles back where
+// close returns pass the mount), so the cost is O(n log r) for r runs, which
+// is linear in practice and never worse than O(n log n).
+//==============================================================================
+static void sortByBearing(Run_t * run, Run_t * scratch)
+{
+	int * run_starts = fusion.run_starts;
+	int count = splitIntoSortedRuns(run, run_starts);
+
+	Run_t * from = run;
+	Run_t * to = scratch;
+	while (count > 1)
+	{
+		// merge neighbouring pairs of runs from one buffer into the other
+		int merged = 0;
+		for (int r = 0; r < count; r += 2)
+		{
+			int i = run_starts[r];
+			int middle = run_starts[r + 1];
+			int end = (r + 2 <= count) ? run_starts[r + 2] : middle;
+			int j = middle;
+			int k = i;
+			while (i < middle && j < end)
+				copyPoint(to, k++, from, (from->bearing[j] < from->bearing[i]) ? j++ : i++);
+			while (i < middle)
+				copyPoint(to, k++, from, i++);
+			while (j < end)
+				copyPoint(to, k++, from, j++);
+			run_starts[merged++] = run_starts[r];
+		}
+		run_starts[merged] = run->num_points;
+		count = merged;
+
+		Run_t * swap = from;
+		from = to;
+		to = swap;
+	}
+
+	if (from != run)
+	{
+		for (int i = 0; i < run->num_points; ++i)
+			copyPoint(run, i, from, i);
+	}
+}
+
+static bool inWindow(uint32_t timestamp, uint32_t window_start, uint32_t window_end)
+{
+	// unsigned differences keep the comparison correct across wrap-around
+	return (uint32_t)(timestamp - window_start) < (uint32_t)(window_end - window_start);
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void ScanFusion_Init(int num_sensors, const ScanFusionMount_t * mounts)
+{
+	fusion.num_sensors = num_sensors;
+	fusion.fused.num_points = 0;
+
+	for (int s = 0; s < num_sensors; ++s)
+	{
+		fusion.mounts[s] = mounts[s];
+		fusion.runs[s].has_scan = false;
+		fusion.runs[s].num_points = 0;
+
+		for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+		{
+			double angle = (a + mounts[s].yaw_degrees) * DEGREES_TO_RADIANS;
+			fusion.cos_table[s][a] = (float)cos(angle);
+			fusion.sin_table[s][a] = (float)sin(angle);
+		}
+	}
+}
+
+void ScanFusion_AddScan(int sensor, uint32_t timestamp, const LidarScan_t * scan)
+{
+	const ScanFusionMount_t * mount = &fusion.mounts[sensor];
+	Run_t * scratch = &fusion.scratch;
+	Run_t * run = &fusion.runs[sensor];
+
+	// transform the returns into the robot frame
+	int n = 0;
+	int start = 0;
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		uint16_t distance = scan->distance[a];
+		if (distance == 0)
+			continue;
+
+		float x = mount->x + distance * fusion.cos_table[sensor][a];
+		float y = mount->y + distance * fusion.sin_table[sensor][a];
+		scratch->x[n] = x;
+		scratch->y[n] = y;
+		scratch->bearing[n] = pseudoAngle(x, y);
+		if (scratch->bearing[n] < scratch->bearing[start])
+			start = n;
+		++n;
+	}
+
+	// rotate the points so that the run starts at the smallest bearing
+	int i = 0;
+	for (int j = start; j < n; ++j)
+		copyPoint(run, i++, scratch, j);
+	for (int j = 0; j < start; ++j)
+		copyPoint(run, i++, scratch, j);
+	run->num_points = n;
+	sortByBearing(run, scratch);
+
+	run->timestamp = timestamp;
+	run->has_scan = true;
+}
+
+const ScanFusionPoints_t * ScanFusion_Fuse(uint32_t window_start, uint32_t window_end)
+{
+	// select the runs that belong to the window
+	const Run_t * runs[ScanFusion_MAX_SENSORS];
+	uint8_t sensors[ScanFusion_MAX_SENSORS];
+	int heads[ScanFusion_MAX_SENSORS];
+	int num_runs = 0;
+	int num_points = 0;
+	for (int s = 0; s < fusion.num_sensors; ++s)
+	{
+		const Run_t * run = &fusion.runs[s];
+		if (!run->has_scan || !inWindow(run->timestamp, window_start, window_end))
+			continue;
+		runs[num_runs] = run;
+		sensors[num_runs] = (uint8_t)s;
+		heads[num_runs] = 0;
+		++num_runs;
+		num_points += run->num_points;
+	}
+
+	// k-way merge: repeatedly take the head with the smallest bearing
+	ScanFusionPoints_t * fused = &fusion.fused;
+	for (int i = 0; i < num_points; ++i)
+	{
+		int best = -1;
+		for (int r = 0; r < num_runs; ++r)
+		{
+			if (heads[r] == runs[r]->num_points)
+				continue;
+			if (best < 0 || runs[r]->bearing[heads[r]] < runs[best]->bearing[heads[best]])
+				best = r;
+		}
+
+		int head = heads[best]++;
+		fused->x[i] = runs[best]->x[head];
+		fused->y[i] = runs[best]->y[head];
+		fused->sensor[i] = sensors[best];
+	}
+	fused->num_points = num_points;
+	return fused;
+}
@@ -0,0 +1,482 @@
+#include "ScanLog.h"
+
+//==============================================================================
+// constants
+//==============================================================================
+
+#define HEADER_SIZE 8
+#define VERSION 1
+
+#define RECORD_REVOLUTION 0x01
+#define RECORD_INDEX_BLOCK 0x02
+#define RECORD_TRAILER 0x03
+
+// payload sizes
+#define MAX_REVOLUTION_SIZE (4 + 3 * LidarScan_NUM_ANGLES)
+#define INDEX_BLOCK_FIELDS_SIZE (8 + 4 + 2)
+#define TRAILER_SIZE 16
+
+// the trailer's type and one-byte length, then its payload
+#define TRAILER_RECORD_SIZE (2 + TRAILER_SIZE)
+
+#define NO_INDEX_BLOCK UINT64_MAX
+
+static const uint8_t header_magic[4] = { 'X', 'V', 'S', 'L' };
+static const uint8_t trailer_magic[4] = { 'X', 'V', 'S', 'X' };
+
+//==============================================================================
+// encoding helpers
+//==============================================================================
+
+static size_t putVarint(uint8_t * out, uint32_t value)
+{
+	size_t n = 0;
+	while (value >= 0x80)
+	{
+		out[n++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[n++] = (uint8_t)value;
+	return n;
+}
+
+static size_t putFixed(uint8_t * out, uint64_t value, int num_bytes)
+{
+	for (int i = 0; i < num_bytes; ++i)
+		out[i] = (uint8_t)(value >> (8 * i));
+	return num_bytes;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static void writeBytes(ScanLogWriter_t * writer, const uint8_t * bytes, size_t count)
+{
+	writer->output->Write(bytes, count);
+	writer->offset += count;
+}
+
+//==============================================================================
+// Writes a record whose payload has been placed in writer->record starting at
+// payload_start, preceded by its type and length.
+//==============================================================================
+static void writeRecord(ScanLogWriter_t * writer, uint8_t type, size_t payload_start, size_t payload_size)
+{
+	uint8_t prefix[6];
+	size_t prefix_size = 0;
+	prefix[prefix_size++] = type;
+	prefix_size += putVarint(prefix + prefix_size, (uint32_t)payload_size);
+
+	// the prefix is placed right in front of the payload so the record is
+	// handed to the output in one piece
+	size_t start = payload_start - prefix_size;
+	for (size_t i = 0; i < prefix_size; ++i)
+		writer->record[start + i] = prefix[i];
+	writeBytes(writer, writer->record + start, prefix_size + payload_size);
+}
+
+static void writeIndexBlock(ScanLogWriter_t * writer)
+{
+	// stream the block in pieces, since it does not fit in the record buffer
+	uint8_t fields[INDEX_BLOCK_FIELDS_SIZE];
+	size_t n = 0;
+	n += putFixed(fields + n, writer->last_index_block, 8);
+	n += putFixed(fields + n, writer->num_revolutions - writer->block_size, 4);
+	n += putFixed(fields + n, writer->block_size, 2);
+
+	uint64_t block_offset = writer->offset;
+	uint8_t prefix[6];
+	size_t prefix_size = 0;
+	prefix[prefix_size++] = RECORD_INDEX_BLOCK;
+	prefix_size += putVarint(prefix + prefix_size, (uint32_t)(n + 8 * writer->block_size));
+	writeBytes(writer, prefix, prefix_size);
+	writeBytes(writer, fields, n);
+	for (int i = 0; i < writer->block_size; ++i)
+	{
+		uint8_t offset[8];
+		putFixed(offset, writer->block_offsets[i], 8);
+		writeBytes(writer, offset, 8);
+	}
+
+	writer->last_index_block = block_offset;
+	writer->block_size = 0;
+}
+
+//==============================================================================
+// decoding helpers
+//==============================================================================
+
+static bool getVarint(const uint8_t * data, size_t * position, size_t end, uint32_t * value)
+{
+	uint32_t result = 0;
+	for (int shift = 0; shift < 35 && *position < end; shift += 7)
+	{
+		uint8_t byte = data[(*position)++];
+		result |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint64_t getFixed(const uint8_t * in, int num_bytes)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < num_bytes; ++i)
+		value |= (uint64_t)in[i] << (8 * i);
+	return value;
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static bool decodeRevolution(const uint8_t * payload, size_t length, uint32_t * timestamp, LidarScan_t * scan)
+{
+	if (length < 4)
+		return false;
+	*timestamp = (uint32_t)getFixed(payload, 4);
+
+	// summed in 64 bits so a corrupt delta cannot overflow; a distance outside
+	// the uint16_t range can only come from a malformed record
+	size_t position = 4;
+	int64_t distance = 0;
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		uint32_t delta;
+		if (!getVarint(payload, &position, length, &delta))
+			return false;
+		distance += unzigzag(delta);
+		if (distance < 0 || distance > UINT16_MAX)
+			return false;
+		scan->distance[a] = (uint16_t)distance;
+	}
+	return true;
+}
+
+//==============================================================================
+// Reads the type and length of the record at the reader's position, leaving
+// the position at the payload. Returns false if the record is cut short.
+//==============================================================================
+static bool readRecordHeader(ScanLogReader_t * reader, uint8_t * type, uint32_t * length)
+{
+	if (reader->position >= reader->size)
+		return false;
+	*type = reader->data[reader->position++];
+	return getVarint(reader->data, &reader->position, reader->size, length)
+		&& *length <= reader->size - reader->position;
+}
+
+//==============================================================================
+// Walks the records of a log without trailer to count its revolutions and find
+// its last index block, stopping at the first incomplete record.
+//==============================================================================
+static void recoverIndex(ScanLogReader_t * reader)
+{
+	reader->position = HEADER_SIZE;
+	reader->unindexed_offset = HEADER_SIZE;
+	reader->first_unindexed = 0;
+
+	uint8_t type;
+	uint32_t length;
+	size_t start = reader->position;
+	while (readRecordHeader(reader, &type, &length))
+	{
+		reader->position += length;
+		if (type == RECORD_REVOLUTION)
+		{
+			++reader->num_revolutions;
+		}
+		else if (type == RECORD_INDEX_BLOCK)
+		{
+			reader->last_index_block = start;
+			reader->unindexed_offset = reader->position;
+			reader->first_unindexed = reader->num_revolutions;
+		}
+		start = reader->position;
+	}
+}
+
+//==============================================================================
+// Finds a revolution written after the last index block by skipping records.
+//==============================================================================
+static bool skipToRevolution(ScanLogReader_t * reader, uint32_t revolution)
+{
+	reader->position = reader->unindexed_offset;
+	uint32_t current = reader->first_unindexed;
+
+	uint8_t type;
+	uint32_t length;
+	size_t start = reader->position;
+	while (readRecordHeader(reader, &type, &length))
+	{
+		if (type == RECORD_REVOLUTION && current++ == revolution)
+		{
+			reader->position = start;
+			return true;
+		}
+		reader->position += length;
+		start = reader->position;
+	}
+	return false;
+}
+
+//==============================================================================
+// ScanLogWriter
+//==============================================================================
+
+void ScanLogWriter_Init(ScanLogWriter_t * writer, ScanLogOutput_i * output)
+{
+	writer->output = output;
+	writer->offset = 0;
+	writer->num_revolutions = 0;
+	writer->last_index_block = NO_INDEX_BLOCK;
+	writer->block_size = 0;
+
+	uint8_t header[HEADER_SIZE] = { header_magic[0], header_magic[1], header_magic[2], header_magic[3], VERSION, 0, 0, 0 };
+	writeBytes(writer, header, HEADER_SIZE);
+}
+
+void ScanLogWriter_AddScan(ScanLogWriter_t * writer, uint32_t timestamp, const LidarScan_t * scan)
+{
+	// leave room in front of the payload for the record type and length
+	size_t payload_start = 6;
+	size_t n = payload_start;
+	n += putFixed(writer->record + n, timestamp, 4);
+
+	int32_t previous = 0;
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		int32_t distance = scan->distance[a];
+		n += putVarint(writer->record + n, zigzag(distance - previous));
+		previous = distance;
+	}
+
+	writer->block_offsets[writer->block_size++] = writer->offset;
+	++writer->num_revolutions;
+	writeRecord(writer, RECORD_REVOLUTION, payload_start, n - payload_start);
+
+	if (writer->block_size == ScanLog_INDEX_BLOCK_SIZE)
+		writeIndexBlock(writer);
+}
+
+void ScanLogWriter_Close(ScanLogWriter_t * writer)
+{
+	if (writer->block_size > 0)
+		writeIndexBlock(writer);
+
+	uint8_t trailer[TRAILER_RECORD_SIZE];
+	size_t n = 0;
+	trailer[n++] = RECORD_TRAILER;
+	trailer[n++] = TRAILER_SIZE;
+	n += putFixed(trailer + n, writer->last_index_block, 8);
+	n += putFixed(trailer + n, writer->num_revolutions, 4);
+	for (int i = 0; i < 4; ++i)
+		trailer[n++] = trailer_magic[i];
+	writeBytes(writer, trailer, n);
+}
+
+//==============================================================================
+// ScanLogReader
+//==============================================================================
+
+bool ScanLogReader_Open(ScanLogReader_t * reader, const uint8_t * data, size_t size)
+{
+	reader->data = data;
+	reader->size = size;
+	reader->position = HEADER_SIZE;
+	reader->has_trailer = false;
+	reader->last_index_block = NO_INDEX_BLOCK;
+	reader->num_revolutions = 0;
+
+	if (size < HEADER_SIZE || data[4] != VERSION)
+		return false;
+	for (int i = 0; i < 4; ++i)
+		if (data[i] != header_magic[i])
+			return false;
+
+	if (size >= HEADER_SIZE + TRAILER_RECORD_SIZE)
+	{
+		const uint8_t * trailer = data + size - TRAILER_RECORD_SIZE;
+		bool has_magic = trailer[0] == RECORD_TRAILER && trailer[1] == TRAILER_SIZE;
+		for (int i = 0; i < 4; ++i)
+			has_magic &= (trailer[14 + i] == trailer_magic[i]);
+		if (has_magic)
+		{
+			reader->has_trailer = true;
+			reader->last_index_block = getFixed(trailer + 2, 8);
+			reader->num_revolutions = (uint32_t)getFixed(trailer + 10, 4);
+			reader->size = size - TRAILER_RECORD_SIZE;
+
+			// the writer indexes every revolution before the trailer
+			reader->unindexed_offset = reader->size;
+			reader->first_unindexed = reader->num_revolutions;
+			return true;
+		}
+	}
+
+	recoverIndex(reader);
+	reader->position = HEADER_SIZE;
+	return true;
+}
+
+bool ScanLogReader_HasIndex(ScanLogReader_t * reader)
+{
+	return reader->has_trailer;
+}
+
+uint32_t ScanLogReader_GetRevolutionCount(ScanLogReader_t * reader)
+{
+	return reader->num_revolutions;
+}
+
+bool ScanLogReader_Seek(ScanLogReader_t * reader, uint32_t revolution)
+{
+	if (revolution >= reader->num_revolutions)
+		return false;
+	if (revolution >= reader->first_unindexed)
+		return skipToRevolution(reader, revolution);
+
+	// walk the chain of index blocks back to the one covering the revolution;
+	// every block must link to an earlier one, so a corrupt chain cannot loop
+	uint64_t limit = reader->size;
+	uint64_t block = reader->last_index_block;
+	while (block < limit && reader->data[block] == RECORD_INDEX_BLOCK)
+	{
+		reader->position = (size_t)block;
+		uint8_t type;
+		uint32_t length;
+		if (!readRecordHeader(reader, &type, &length) || length < INDEX_BLOCK_FIELDS_SIZE)
+			return false;
+
+		const uint8_t * fields = reader->data + reader->position;
+		uint32_t first = (uint32_t)getFixed(fields + 8, 4);
+		uint32_t count = (uint32_t)getFixed(fields + 12, 2);
+		if (revolution >= first && revolution - first < count && INDEX_BLOCK_FIELDS_SIZE + 8 * count <= length)
+		{
+			reader->position = (size_t)getFixed(fields + INDEX_BLOCK_FIELDS_SIZE + 8 * (revolution - first), 8);
+			return reader->position < reader->size;
+		}
+		limit = block;
+		block = getFixed(fields, 8);
+	}
+	return false;
+}
+
+bool ScanLogReader_Next(ScanLogReader_t * reader, uint32_t * timestamp, LidarScan_t * scan)
+{
+	uint8_t type;
+	uint32_t length;
+	while (readRecordHeader(reader, &type, &length))
+	{
+		size_t end = reader->position + length;
+		if (type == RECORD_REVOLUTION)
+		{
+			bool decoded = decodeRevolution(reader->data + reader->position, length, timestamp, scan);
+			reader->position = end;
+			return decoded;
+		}
+		reader->position = end;
+	}
+	return false;
+}
+
+//==============================================================================
+// ScanLogDecoder
+//==============================================================================
+
+// decoder stages
+enum
+{
+	DecodingHeader,
+	DecodingType,
+	DecodingLength,
+	DecodingPayload
+};
+
+static void finishRecord(ScanLogDecoder_t * decoder)
+{
+	decoder->stage = DecodingType;
+	if (decoder->type != RECORD_REVOLUTION)
+		return;
+
+	uint32_t timestamp;
+	if (!decodeRevolution(decoder->record, decoder->length, &timestamp, &decoder->scan))
+	{
+		decoder->failed = true;
+		return;
+	}
+	decoder->output->AddScan(timestamp, &decoder->scan);
+}
+
+static void decodeByte(ScanLogDecoder_t * decoder, uint8_t byte)
+{
+	switch (decoder->stage)
+	{
+	case DecodingHeader:
+		if ((decoder->header_size < 4 && byte != header_magic[decoder->header_size])
+			|| (decoder->header_size == 4 && byte != VERSION))
+			decoder->failed = true;
+		if (++decoder->header_size == HEADER_SIZE)
+			decoder->stage = DecodingType;
+		break;
+
+	case DecodingType:
+		decoder->type = byte;
+		decoder->length = 0;
+		decoder->length_shift = 0;
+		decoder->stage = DecodingLength;
+		break;
+
+	case DecodingLength:
+		if (decoder->length_shift >= 35)
+		{
+			decoder->failed = true;
+			break;
+		}
+		decoder->length |= (uint32_t)(byte & 0x7F) << decoder->length_shift;
+		decoder->length_shift += 7;
+		if (byte & 0x80)
+			break;
+
+		// only revolutions are buffered, so only they are limited in size
+		if (decoder->type == RECORD_REVOLUTION && decoder->length > MAX_REVOLUTION_SIZE)
+		{
+			decoder->failed = true;
+			break;
+		}
+		decoder->payload_size = 0;
+		decoder->stage = DecodingPayload;
+		if (decoder->length == 0)
+			finishRecord(decoder);
+		break;
+
+	case DecodingPayload:
+		if (decoder->type == RECORD_REVOLUTION)
+			decoder->record[decoder->payload_size] = byte;
+		if (++decoder->payload_size == decoder->length)
+			finishRecord(decoder);
+		break;
+	}
+}
+
+void ScanLogDecoder_Init(ScanLogDecoder_t * decoder, ScanLogDecoderOutput_i * output)
+{
+	decoder->output = output;
+	decoder->stage = DecodingHeader;
+	decoder->header_size = 0;
+	decoder->failed = false;
+}
+
+bool ScanLogDecoder_Feed(ScanLogDecoder_t * decoder, const uint8_t * bytes, size_t count)
+{
+	for (size_t i = 0; i < count && !decoder->failed; ++i)
+		decodeByte(decoder, bytes[i]);
+	return !decoder->failed;
+}
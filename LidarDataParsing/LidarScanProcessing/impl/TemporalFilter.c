@@ -0,0 +1,164 @@
+#include "TemporalFilter.h"
+
+#include <stdbool.h>
+
+//==============================================================================
+// filter state
+//
+// History is kept as one distance array per revolution (structure of arrays),
+// so that combining revolutions is a set of loops over contiguous angle slots.
+// The running sum and count per angle are kept up to date on every
+// measurement, which makes the mean O(1) per measurement.
+//==============================================================================
+
+static struct
+{
+	TemporalFilterMode_t mode;
+	int depth;
+
+	// ring of past revolutions; `slot` is the one currently being filled
+	uint16_t history[TemporalFilter_MAX_DEPTH][LidarScan_NUM_ANGLES];
+	int slot;
+
+	// running sum and number of non-zero readings per angle over the ring
+	uint32_t sum[LidarScan_NUM_ANGLES];
+	uint8_t count[LidarScan_NUM_ANGLES];
+
+	// progress through the current revolution
+	LidarRevolution_t revolution;
+	int size;
+	uint32_t revolutions;
+
+	// output of the last completed revolution
+	LidarScan_t filtered;
+
+	// scratch space for the median sort
+	uint16_t sorted[TemporalFilter_MAX_DEPTH][LidarScan_NUM_ANGLES];
+}
+filter;
+
+//==============================================================================
+// helper methods
+//==============================================================================
+
+static void computeMean()
+{
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		uint32_t n = filter.count[a];
+		filter.filtered.distance[a] = (uint16_t)(n ? filter.sum[a] / n : 0);
+	}
+}
+
+//==============================================================================
+// Sorts every angle column of the history with an odd-even transposition
+// network. Each compare-exchange step is a min/max over all 360 angles. Zero
+// readings are mapped to 0xFFFF (by subtracting 1) so they sort last and the
+// median can be taken from the first `count` entries of each column.
+//==============================================================================
+static void computeMedian()
+{
+	int depth = filter.depth;
+
+	for (int s = 0; s < depth; ++s)
+		for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+			filter.sorted[s][a] = (uint16_t)(filter.history[s][a] - 1);
+
+	for (int pass = 0; pass < depth; ++pass)
+	{
+		for (int s = pass & 1; s + 1 < depth; s += 2)
+		{
+			uint16_t * lo = filter.sorted[s];
+			uint16_t * hi = filter.sorted[s + 1];
+			for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+			{
+				uint16_t x = lo[a];
+				uint16_t y = hi[a];
+				lo[a] = (x < y) ? x : y;
+				hi[a] = (x < y) ? y : x;
+			}
+		}
+	}
+
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		int n = filter.count[a];
+		int median = n ? (n - 1) / 2 : 0;
+		filter.filtered.distance[a] = (uint16_t)(filter.sorted[median][a] + 1);
+	}
+}
+
+static void completeRevolution()
+{
+	if (filter.mode == TemporalFilter_MEDIAN)
+		computeMedian();
+	else
+		computeMean();
+	++filter.revolutions;
+
+	// advance to the oldest revolution and remove it from the running totals
+	filter.slot = (filter.slot + 1 == filter.depth) ? 0 : filter.slot + 1;
+	uint16_t * oldest = filter.history[filter.slot];
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		filter.sum[a] -= oldest[a];
+		filter.count[a] -= (oldest[a] != 0);
+		oldest[a] = 0;
+	}
+	filter.size = 0;
+}
+
+//==============================================================================
+// public methods
+//==============================================================================
+
+void TemporalFilter_Init(int depth, TemporalFilterMode_t mode)
+{
+	filter.mode = mode;
+	filter.depth = depth;
+	filter.slot = 0;
+	LidarRevolution_Reset(&filter.revolution);
+	filter.size = 0;
+	filter.revolutions = 0;
+
+	for (int s = 0; s < TemporalFilter_MAX_DEPTH; ++s)
+		for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+			filter.history[s][a] = 0;
+
+	for (int a = 0; a < LidarScan_NUM_ANGLES; ++a)
+	{
+		filter.sum[a] = 0;
+		filter.count[a] = 0;
+		filter.filtered.distance[a] = 0;
+	}
+}
+
+void TemporalFilter_AddMeasurement(uint16_t index, uint16_t distance)
+{
+	if (index >= LidarScan_NUM_ANGLES)
+		return;
+
+	if (LidarRevolution_Next(&filter.revolution, index))
+		completeRevolution();
+
+	uint16_t * current = &filter.history[filter.slot][index];
+	filter.sum[index] += (uint32_t)distance - *current;
+	filter.count[index] += (distance != 0) - (*current != 0);
+	*current = distance;
+	++filter.size;
+}
+
+int TemporalFilter_GetSize()
+{
+	return filter.size;
+}
+
+uint32_t TemporalFilter_GetRevolutionCount()
+{
+	return filter.revolutions;
+}
+
+const LidarScan_t * TemporalFilter_GetScan()
+{
+	return &filter.filtered;
+}